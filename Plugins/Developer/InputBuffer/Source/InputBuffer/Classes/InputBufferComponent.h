@@ -6,110 +6,18 @@
 #include "InputCoreTypes.h"
 
 #include "BufferedInputEventKit.h"
-#include "CyclicBuffer.h"
+#include "CompiledInputCommand.h"
+#include "InputBufferRecord.h"
+#include "InputBufferSchema.h"
+#include "InputCommandRecognizer.h"
+#include "InputHistory.h"
 #include "InputHistoryRecordArray.h"
+#include "InputRecording.h"
 
 #include "InputBufferComponent.generated.h"
 
-UENUM(BlueprintType)
-enum class EBufferedInputEventType : uint8
-{
-	Pressed = 0,
-	Released = 1,
-	Held = 2,
-};
-
-USTRUCT(BlueprintType)
-struct FBufferedInputEventSetup
-{
-	GENERATED_BODY()
-
-	FBufferedInputEventSetup()
-		: bEnabled(true)
-		, Name(NAME_None)
-		, Type(EBufferedInputEventType::Pressed)
-		, bExecuteWhenPaused(false)
-		, KeyMappingName(NAME_None)
-	{}
-
-	/** Whether this event is enabled. */
-	UPROPERTY(EditAnywhere, Category = "Input Buffer")
-	bool bEnabled;
-
-	/** Name of input event, e.g "Jump" */
-	UPROPERTY(EditAnywhere, Category = "Input Buffer")
-	FName Name;
-
-	/** Type of the input event. */
-	UPROPERTY(EditAnywhere, Category = "Input Buffer")
-	EBufferedInputEventType Type;
-
-	/** Should the event get triggered even when the game is paused? */
-	UPROPERTY(EditAnywhere, Category = "Input Buffer")
-	bool bExecuteWhenPaused;
-
-	/** Name of key mapping to use for this event. */
-	UPROPERTY(EditAnywhere, Category = "Input Buffer")
-	FName KeyMappingName;
-
-	/** Keys to bind it to. */
-	UPROPERTY(EditAnywhere, Category = "Input Buffer")
-	TArray<FKey> Keys;
-};
-
-USTRUCT(BlueprintType)
-struct FBufferedInputEventKeyMapping
-{
-	GENERATED_BODY()
-
-	FBufferedInputEventKeyMapping() : Name(NAME_None) {}
-
-	/** Name of this mapping. */
-	UPROPERTY(EditAnywhere, Category = "Input Buffer")
-	FName Name;
-
-	/** Keys to bind it to. */
-	UPROPERTY(EditAnywhere, Category = "Input Buffer")
-	TArray<FKey> Keys;
-};
- 
-/* Stored in input buffers to represent the same input status over one or several frames. */
-struct FInputBufferRecord
-{
-	FInputBufferRecord()
-		: bValid(false)
-		, StartTime(0.f)
-		, EndTime(0.f)
-		, Events(0)
-		, TranslatedEvents(0)
-	{}
-
-	FInputBufferRecord(float InStarTime, float InEndTime, uint64 InEvents, uint64 InTranslatedEvents, bool bInValid = true)
-		: bValid(bInValid)
-		, StartTime(InStarTime)
-		, EndTime(InEndTime)
-		, Events(InEvents)
-		, TranslatedEvents(InTranslatedEvents)
-	{}
-
-	/** Whether this record is valid. */
-	bool bValid;
-
-	/** Time when we start to record it. */
-	float StartTime;
-
-	/** Time when we stop recording it. */
-	float EndTime;
-
-	/** Bit flags of input events. */
-	uint64 Events;
-
-	/** Input events that are translated from. */
-	uint64 TranslatedEvents;
-
-	/** Input event capacity = the number of bits of event flags. */
-	static const int32 MAX_EVENTS = sizeof(uint64) * 8;
-};
+/* Called when a watched input command starts to match the input history. */
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnInputCommandRecognized, class UInputCommand* /*Command*/);
 
 /**
 * A component used to store input data for input buffering.
@@ -126,10 +34,21 @@ public:
 
 public:
 
+	/**
+	* An optional schema shared with other input buffers, e.g. for split-screen players or AI characters.
+	* If set, EventSetups, StickSetups, TranslatedEvents and KeyMappings are ignored and the compiled schema is shared instead of built per component.
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Input Buffer")
+	class UInputBufferSchema* Schema;
+
 	/* Input events set-up information. */
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Input Buffer")
 	TArray<FBufferedInputEventSetup> EventSetups;
 
+	/* Analog sticks quantized into direction events. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Input Buffer")
+	TArray<FBufferedInputStickSetup> StickSetups;
+
 	/* A list of input events into which others could be translated. */
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Input Buffer")
 	TArray<FName> TranslatedEvents;
@@ -142,14 +61,40 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Input Buffer", Meta = (ClampMin = 0, UIMin = 0))
 	int32 MaxInputHistory;
 
+	/* Input commands recognized incrementally whenever input is buffered. See IsCommandRecognized. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Input Buffer")
+	TArray<class UInputCommand*> WatchedCommands;
+
+	/**
+	* If true, key presses and releases are captured as they arrive instead of being polled once per frame.
+	* Each transition is buffered with its own timestamp, so quick taps within a frame are not merged and intervals do not depend on the frame rate.
+	*
+	* Limitation: Timestamps are taken when the owner controller's InputKey is called, i.e. when the engine pumps the event to the player
+	* controller, not when the OS delivered it. Events pumped in one batch get nearly identical timestamps.
+	* Timestamps are mapped onto GetCurrentTime() using its rate over the last frame, so a dilated clock scales the intervals too.
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Input Buffer")
+	bool bCaptureKeyEvents;
+
+	/**
+	* If true, raised events are translated with a native table instead of calling the owner controller's TranslateInputEvent for every event.
+	* The table is filled by AInputBufferPlayerController::RefreshEventTranslations, which should be called whenever the translation context changes.
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Input Buffer")
+	bool bNativeEventTranslation;
+
+	/* Called when a watched input command starts to match the input history. */
+	FOnInputCommandRecognized OnCommandRecognized;
+
 public:
 
 	//~ Begin UActorComponent Interface
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 	//~ End UActorComponent Interface
 
 	/**
-	* Resets internal data structures according to EventSetups. Should be called after changes to EventSetups are made.
+	* Resets internal data structures according to Schema, or EventSetups if there is no schema. Should be called after changes to either are made.
 	*
 	* Caution: Calling this function will clear the input buffer.
 	*
@@ -164,16 +109,109 @@ public:
 	/* Called by the owner controller's PostProcessInput. */
 	void OnPostProcessInput(class UPlayerInput* PlayerInput, const bool bGamePaused);
 
+	/* Called by the owner controller's InputKey as soon as a key event arrives. Only used if bCaptureKeyEvents is true. */
+	void OnInputKey(const FKey& Key, EInputEvent EventType);
+
+	/**
+	* Buffers given input events at a given time without polling keys. Used to drive the input buffer with generated input.
+	*
+	* @param Events Raised input events. They are translated the same way as events raised by keys.
+	* @param Time The time of the input. Must not be earlier than the last buffered input.
+	*/
+	void ProcessEvents(const FInputEventFlags& Events, float Time);
+
+	/**
+	* Sets the translation of an input event in the native translation table. Used if bNativeEventTranslation is true.
+	*
+	* @param Event The event to translate.
+	* @param TranslatedEvent The event into which Event is translated. None means Event is dropped.
+	* @return Whether both events are known.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Input Buffer")
+	bool SetEventTranslation(FName Event, FName TranslatedEvent);
+
+	/* Resets the native translation table so that no event is translated. */
+	UFUNCTION(BlueprintCallable, Category = "Input Buffer")
+	void ResetEventTranslations();
+
+	/* Sets the translation of every input event in the native translation table with a given function. */
+	void UpdateEventTranslations(TFunctionRef<FName(FName)> Translate);
+
+	/**
+	* Starts streaming every buffered input to a compact binary file. See InputRecording.h for the format.
+	*
+	* Caution: Calling Initialize() stops recording.
+	*
+	* @param FileName Name of the file. A relative path is relative to Saved/InputRecordings.
+	* @return Whether the file is opened.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Input Buffer")
+	bool StartRecording(const FString& FileName);
+
+	/* Stops recording and closes the file. */
+	UFUNCTION(BlueprintCallable, Category = "Input Buffer")
+	void StopRecording();
+
+	/* Returns whether buffered input is being recorded. */
+	UFUNCTION(BlueprintCallable, Category = "Input Buffer")
+	bool IsRecording() const { return Recorder.IsValid(); }
+
+	/**
+	* Starts feeding a recorded file back into the input buffer at the original timing, relative to now.
+	* Player input is ignored until the replay ends. Recorded events are matched to registered events by name, and unknown events are dropped.
+	*
+	* Caution: Calling Initialize() stops replaying.
+	*
+	* @param FileName Name of the file. A relative path is relative to Saved/InputRecordings.
+	* @return Whether the file is opened and valid.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Input Buffer")
+	bool StartReplay(const FString& FileName);
+
+	/* Stops replaying and goes back to player input. */
+	UFUNCTION(BlueprintCallable, Category = "Input Buffer")
+	void StopReplay();
+
+	/* Returns whether a recording is being replayed. */
+	UFUNCTION(BlueprintCallable, Category = "Input Buffer")
+	bool IsReplaying() const { return ReplayReader.IsValid(); }
+
+	/**
+	* Preallocates a ring of snapshots for saving and restoring the state of the input buffer every frame, e.g. for rollback.
+	*
+	* @param NumFrames The number of latest frames which can be restored. Zero frees the ring.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Input Buffer")
+	void ReserveSnapshots(int32 NumFrames);
+
+	/**
+	* Saves the input history, the current record, key states and recognizer progress into the snapshot ring, replacing the snapshot NumFrames before.
+	* Every part is copied with a memcpy into preallocated memory.
+	*
+	* @param Frame A non-negative frame number.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Input Buffer")
+	void SaveSnapshot(int32 Frame);
+
+	/**
+	* Restores the state saved for a given frame without allocating.
+	* Snapshots are dropped when watched commands change or the capacity of the input buffer changes.
+	*
+	* @return Whether a snapshot of the frame is in the ring.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Input Buffer")
+	bool RestoreSnapshot(int32 Frame);
+
 	/* Clears the input buffer. */
 	UFUNCTION(BlueprintCallable, Category = "Input Buffer")
 	void ClearHistory();
 
-	/* Invalidates the input buffer. The records in the buffer are still there but they will be no longer valid for command recognition. */
+	/* Invalidates the input buffer in constant time. The records in the buffer are still there but they will be no longer valid for command recognition. */
 	UFUNCTION(BlueprintCallable, Category = "Input Buffer")
 	void InvalidateHistory();
 
-	bool ConvertEventsToFlags(const TArray<FName>& Events, uint64& Flags) const;
-	void ConvertFlagsToEvents(uint64 Flags, TArray<FName>& Events) const;
+	bool ConvertEventsToFlags(const TArray<FName>& Events, FInputEventFlags& Flags) const;
+	void ConvertFlagsToEvents(const FInputEventFlags& Flags, TArray<FName>& Events) const;
 
 	/**
 	* Prints the content of the input buffer to a string.
@@ -207,6 +245,35 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Input Buffer")
 	float GetLastEvents(TArray<FName>& Events, float TimeLimit = 0.f, bool bSkipEmptyTrail = true) const;
 
+	/**
+	* Returns how long an input event has been held, i.e. how long any of its keys has been down, regardless of the type of the event.
+	*
+	* @return The held duration, or zero if the event is not held.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Input Buffer")
+	float GetHeldDuration(FName Event) const;
+
+	/* Returns the time since any key of an input event last went down, or -1 if it never did. */
+	UFUNCTION(BlueprintCallable, Category = "Input Buffer")
+	float GetTimeSincePressed(FName Event) const;
+
+	/* Returns the time since the last key of an input event was released, or -1 if it never was. */
+	UFUNCTION(BlueprintCallable, Category = "Input Buffer")
+	float GetTimeSinceReleased(FName Event) const;
+
+	/**
+	* Versions of GetHeldDuration, GetTimeSincePressed and GetTimeSinceReleased callable from any thread, e.g. from animation graphs.
+	* They read a copy published each time input is processed, so times are measured up to the last processed input rather than now.
+	*/
+	UFUNCTION(BlueprintPure, Category = "Input Buffer", Meta = (BlueprintThreadSafe))
+	float GetHeldDurationAnyThread(FName Event) const;
+
+	UFUNCTION(BlueprintPure, Category = "Input Buffer", Meta = (BlueprintThreadSafe))
+	float GetTimeSincePressedAnyThread(FName Event) const;
+
+	UFUNCTION(BlueprintPure, Category = "Input Buffer", Meta = (BlueprintThreadSafe))
+	float GetTimeSinceReleasedAnyThread(FName Event) const;
+
 	/**
 	* Retrieves input records in the input buffer in chronological order.
 	*
@@ -221,7 +288,7 @@ public:
 	* Sets input history to given records. 
 	* The given records must be in chronological order, and their timespan cannot overlap.
 	*
-	* Caution: The given records MUST be valid. If incorrect data is inputted, the input buffer may malfunction until those records are flushed out. 
+	* Caution: The given records MUST be valid and in chronological order. If incorrect data is inputted, the input buffer may malfunction until those records are flushed out. 
 	*
 	* @param Records An array of given input records.
 	* @return Whether there is an error during the process.
@@ -244,39 +311,237 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Input Buffer")
 	bool MatchCommand(class UInputCommand* Command) const;
 
+	/**
+	* Matches a given InputCommand and, if it matches, invalidates only the records used by the match.
+	* Unlike InvalidateHistory, input after the match is kept for other commands.
+	*
+	* @return Whether the command matches.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Input Buffer")
+	bool ConsumeCommand(class UInputCommand* Command);
+
+	/**
+	* Matches several InputCommands in a single pass over the input history.
+	*
+	* @param Commands Input commands to match.
+	* @param OutMatched An output array of the matched commands, in the same order as given.
+	* @return Whether any command matches.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Input Buffer")
+	bool MatchCommands(const TArray<class UInputCommand*>& Commands, TArray<class UInputCommand*>& OutMatched) const;
+
+	/**
+	* Returns the first matching InputCommand of a given list in a single pass over the input history.
+	*
+	* @param Commands Input commands to match, in descending order of priority.
+	* @return The matched command with the highest priority, or null if none matches.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Input Buffer")
+	class UInputCommand* MatchFirstCommand(const TArray<class UInputCommand*>& Commands) const;
+
+	/* Starts recognizing a given command incrementally. */
+	UFUNCTION(BlueprintCallable, Category = "Input Buffer")
+	void WatchCommand(class UInputCommand* Command);
+
+	/* Stops recognizing a given command incrementally. */
+	UFUNCTION(BlueprintCallable, Category = "Input Buffer")
+	void UnwatchCommand(class UInputCommand* Command);
+
+	/**
+	* Returns whether a watched command matches the input history as of the last processed input, without scanning the history.
+	* The result is the same as MatchCommand at that time.
+	*
+	* @param Command A command in WatchedCommands.
+	* @return Whether the command matches. Always false for commands not watched.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Input Buffer")
+	bool IsCommandRecognized(class UInputCommand* Command) const;
+
+	/**
+	* Returns the compiled form of a given command. Commands are compiled on first use and cached until Initialize() is called.
+	*
+	* Caution: Call Initialize() after modifying a command at runtime, otherwise the cached form is used.
+	*/
+	const FCompiledInputCommand& GetCompiledCommand(const class UInputCommand* Command) const;
+
+	/* Returns the compiled events and keys in use. */
+	const FCompiledInputBufferSchema& GetRuntimeSchema() const { return *RuntimeSchema; }
+
+	/* Returns the input history, e.g. for debug display. */
+	const FInputHistory& GetInputHistory() const { return InputHistory; }
+
 protected:
 
 	FInputBufferRecord CurrentRecord;
 
-	TCyclicBuffer<FInputBufferRecord> InputHistory;
+	FInputHistory InputHistory;
+
+	/* Events, keys and masks, either shared through Schema or compiled for this component alone. Never null. */
+	TSharedPtr<const FCompiledInputBufferSchema> RuntimeSchema;
 
-	TArray<FBufferedInputEventSetup> RuntimeEvents;
+	/* Key states packed into RuntimeSchema->NumKeyWords words each. The directions of sticks are virtual keys, so their hysteresis is kept here as well. */
+	TArray<uint64> KeyStates1;
+	TArray<uint64> KeyStates2;
 
-	TMap<FName, int32> EventIndexMap;
+	TArray<uint64>* PreviousKeyStates;
+	TArray<uint64>* CurrentKeyStates;
 
-	TMap<FKey, int32> KeyIndexMap;
+	/* Pressed, released and held key bits of the current frame, NumKeyWords words each, in the order of EBufferedInputEventType. */
+	TArray<uint64> KeyEdges;
 
-	TBitArray<> KeyStates1;
-	TBitArray<> KeyStates2;
+	/* Events with any key down, as of the last processed key states. */
+	FInputEventFlags EventsDown;
 
-	TBitArray<>* PreviousKeyStates;
-	TBitArray<>* CurrentKeyStates;
+	/* The time when each event last went down and up, or -MAX_flt if it never did. */
+	TArray<float> EventPressTimes;
+	TArray<float> EventReleaseTimes;
+
+	/* Copy of the event times read by the AnyThread queries. Written on the game thread only, under PublishedEventTimesLock. */
+	struct FPublishedEventTimes
+	{
+		TMap<FName, int32> EventIndexMap;
+		FInputEventFlags EventsDown;
+		TArray<float> PressTimes;
+		TArray<float> ReleaseTimes;
+
+		/* The time of the last processed input. */
+		float Time;
+	};
+
+	FPublishedEventTimes PublishedEventTimes;
+
+	mutable FCriticalSection PublishedEventTimesLock;
+
+	/* The index of the event into which each event is translated, or INDEX_NONE if the event is dropped. */
+	TArray<int32> TranslationTargets;
+
+	/* Events whose translation differs from themselves. */
+	FInputEventFlags TranslatedEventMask;
+
+	/* A key transition captured before input is processed. */
+	struct FQueuedKeyEvent
+	{
+		int32 KeyIndex;
+		bool bDown;
+
+		/* Timestamp from FPlatformTime::Seconds() when the controller received the event, not when the OS delivered it. */
+		double Timestamp;
+	};
+
+	/* Key transitions captured since the last time input was processed. */
+	TArray<FQueuedKeyEvent> QueuedKeyEvents;
+
+	/* GetCurrentTime() and FPlatformTime::Seconds() the last time input was processed. Used to map key event timestamps. */
+	float LastTimeSample;
+	double LastPlatformTimeSample;
+
+	/* Commands not in the shared schema, compiled against its events. */
+	mutable TMap<TWeakObjectPtr<const UInputCommand>, FCompiledInputCommand> CompiledCommands;
+
+	/* Incremental recognizer of WatchedCommands. */
+	FInputCommandRecognizer Recognizer;
+
+	/* Snapshots of SnapshotSize bytes each, in a ring indexed by frame number. */
+	TArray<uint8> SnapshotData;
+
+	/* The frame saved in each snapshot, or INDEX_NONE. */
+	TArray<int32> SnapshotFrames;
+
+	int32 SnapshotSize;
+
+	TUniquePtr<FArchive> RecordingArchive;
+	TUniquePtr<FInputRecordingWriter> Recorder;
+
+	TUniquePtr<FArchive> ReplayArchive;
+	TUniquePtr<FInputRecordingReader> ReplayReader;
+
+	/* The event index of each recorded event bit in the replay, or INDEX_NONE if the event is not registered. Empty if the indices are the same. */
+	TArray<int32> ReplayEventMap;
+
+	/* The time when the replay started. Recorded times are relative to it. */
+	float ReplayStartTime;
+
+	/* The next recorded frame, read ahead of time. */
+	bool bHasReplayFrame;
+	double ReplayFrameTime;
+	FInputEventFlags ReplayEvents;
+	FInputEventFlags ReplayTranslatedEvents;
+
+	/* Indices of WatchedCommands in the recognizer. */
+	TMap<TWeakObjectPtr<const UInputCommand>, int32> WatchedCommandIndexMap;
 
 protected:
 
 	/* Returns the current time used internally in the input buffer. Override this if you wish to use another time function other than GetWorld()->GetRealTimeSeconds(). */
 	virtual float GetCurrentTime() const;
 
-	/* Note returned record is valid only before new records are added to the input buffer. */
-	const FInputBufferRecord* GetLastRecord(float TimeLimit, bool bSkipEmptyTrail) const;
-	const FInputBufferRecord* GetLastRecord(float TimeLimit) const;
-	const FInputBufferRecord* GetLastNonEmptyRecord(float TimeLimit) const;
+	/* Copies the event times for other threads. The event index map is only copied when the schema changed. */
+	void PublishEventTimes(bool bSchemaChanged);
 
-	FString EventFlagsToString(uint64 Actions, const FString& Separator = ", ") const;
+	/* Returns the index of the last valid record within a time limit in the input history, or INDEX_NONE. Note returned index is valid only before new records are added to the input buffer. */
+	int32 FindLastRecord(float TimeLimit, bool bSkipEmptyTrail) const;
+
+	FString EventFlagsToString(const FInputEventFlags& Events, const FString& Separator = ", ") const;
+
+	/**
+	* Matches a compiled command against the input history.
+	*
+	* @param OutFirstUsed (Optional) The index of the oldest record used by the match. INDEX_NONE if no record is used.
+	* @param OutLastUsed (Optional) The index of the latest record used by the match. INDEX_NONE if no record is used.
+	*/
+	bool MatchCompiledCommand(const FCompiledInputCommand& Command, float CurrTime, int32* OutFirstUsed = nullptr, int32* OutLastUsed = nullptr) const;
+
+	/* Invalidates the records in [FirstIndex, LastIndex] and makes sure older records no longer take part in recognition. */
+	void ConsumeRecords(int32 FirstIndex, int32 LastIndex);
+
+	/* Returns the number of bytes needed by a snapshot with the current capacity and watched commands. */
+	int32 GetSnapshotSize() const;
+
+	/* Drops all saved snapshots. */
+	void InvalidateSnapshots();
+
+	/* Recompiles WatchedCommands into the recognizer. */
+	void RebuildRecognizer();
+
+	/* Feeds the whole input history to the recognizer after the history is replaced. */
+	void ReplayHistoryToRecognizer();
+
+	/* Evaluates the recognizer and broadcasts OnCommandRecognized if bNotify is true. Recognized commands with bConsumeInput consume their input in the order of WatchedCommands. */
+	void UpdateRecognizedCommands(float CurrTime, bool bNotify);
+
+	/* Matches a set of commands at once and returns the index of the first matched one. If bFirstOnly is true, stops as soon as it is decided. */
+	int32 MatchCommandSet(const TArray<class UInputCommand*>& Commands, bool bFirstOnly, TArray<EInputCommandMatchResult, TInlineAllocator<64>>& Results) const;
 
 	void ProcessInput(UPlayerInput* PlayerInput, const bool bGamePaused);
 
-	void RecordEvent(uint64 EventIndex, class AInputBufferPlayerController* Controller);
+	/* Buffers recorded frames which are due at a given time. */
+	void ProcessReplay(float CurrTime, class AInputBufferPlayerController* Controller);
+
+	/* Reads the next recorded frame and maps its events onto registered events. */
+	void ReadReplayFrame();
+
+	/* Returns the path of a recording file. */
+	static FString GetRecordingPath(const FString& FileName);
+
+	/* Buffers a record for each captured key transition, at the time it arrived. */
+	void ProcessQueuedKeyEvents(float CurrTime, const bool bGamePaused, class AInputBufferPlayerController* Controller);
+
+	/* Remembers both clocks at the time input is processed. */
+	void SampleClocks(float CurrTime);
+
+	/* Resets the current record to an empty one at a given time. */
+	void BeginRecord(float Time);
+
+	/* Adds the current record to the input buffer, or prolongs the last record if events are the same. */
+	void CommitRecord(class AInputBufferPlayerController* Controller);
+
+	/* Returns the events raised by the transition from PreviousKeyStates to CurrentKeyStates, and updates held events at the time of the current record. */
+	FInputEventFlags ComputeRaisedEvents(const bool bGamePaused);
+
+	/* Records raised events in ascending order of event indices. */
+	void RecordEvents(const FInputEventFlags& Events, class AInputBufferPlayerController* Controller);
+
+	void RecordEvent(int32 EventIndex, class AInputBufferPlayerController* Controller);
 
 };
 
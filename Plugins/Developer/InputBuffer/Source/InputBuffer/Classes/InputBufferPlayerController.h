@@ -5,6 +5,7 @@
 #include "GameFramework/PlayerController.h"
 
 #include "InputBufferComponent.h"
+#include "InputBufferDebugTimeline.h"
 
 #include "InputBufferPlayerController.generated.h"
 
@@ -24,8 +25,6 @@ public:
 
 public:
 
-	static const int32 MAX_INPUT_HISTORY_TO_DEBUG_DISPLAY = 20;
-
 	/** Name of the input buffer component. Use this name if you want to use a different class (with ObjectInitializer.SetDefaultSubobjectClass). */
 	static FName InputBufferComponentName;
 
@@ -38,6 +37,7 @@ public:
 	//~ Begin APlayerController Interface
 	virtual void PreProcessInput(const float DeltaTime, const bool bGamePaused) override;
 	virtual void PostProcessInput(const float DeltaTime, const bool bGamePaused) override;
+	virtual bool InputKey(FKey Key, EInputEvent EventType, float AmountDepressed, bool bGamepad) override;
 	//~ End APlayerController Interface
 
 	/* Returns input buffer subobject. */
@@ -51,9 +51,19 @@ public:
 	UFUNCTION(BlueprintNativeEvent, Category = "Input Buffer")
 	FName TranslateInputEvent(FName Event);
 
+	/**
+	* Rebuilds the native translation table of the input buffer by calling TranslateInputEvent once per input event.
+	* Call this whenever the result of TranslateInputEvent changes if the input buffer uses native event translation.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Input Buffer")
+	void RefreshEventTranslations();
+
 protected:
 
 	/** Component of input buffer */
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Input Buffer", Meta = (AllowPrivateAccess = "true"))
 	class UInputBufferComponent* InputBuffer;
+
+	/** Timeline of buffered input drawn by DisplayDebug */
+	FInputBufferDebugTimeline DebugTimeline;
 };
@@ -0,0 +1,256 @@
+// Copyright 2018 Isaac Hsu.
+
+#pragma once
+
+#include "Engine/DataAsset.h"
+#include "InputCoreTypes.h"
+
+#include "CompiledInputCommand.h"
+#include "InputEventFlags.h"
+
+#include "InputBufferSchema.generated.h"
+
+UENUM(BlueprintType)
+enum class EBufferedInputEventType : uint8
+{
+	Pressed = 0,
+	Released = 1,
+	Held = 2,
+};
+
+USTRUCT(BlueprintType)
+struct FBufferedInputEventSetup
+{
+	GENERATED_BODY()
+
+	FBufferedInputEventSetup()
+		: bEnabled(true)
+		, Name(NAME_None)
+		, Type(EBufferedInputEventType::Pressed)
+		, bExecuteWhenPaused(false)
+		, KeyMappingName(NAME_None)
+	{}
+
+	/** Whether this event is enabled. */
+	UPROPERTY(EditAnywhere, Category = "Input Buffer")
+	bool bEnabled;
+
+	/** Name of input event, e.g "Jump" */
+	UPROPERTY(EditAnywhere, Category = "Input Buffer")
+	FName Name;
+
+	/** Type of the input event. */
+	UPROPERTY(EditAnywhere, Category = "Input Buffer")
+	EBufferedInputEventType Type;
+
+	/** Should the event get triggered even when the game is paused? */
+	UPROPERTY(EditAnywhere, Category = "Input Buffer")
+	bool bExecuteWhenPaused;
+
+	/** Name of key mapping to use for this event. */
+	UPROPERTY(EditAnywhere, Category = "Input Buffer")
+	FName KeyMappingName;
+
+	/** Keys to bind it to. */
+	UPROPERTY(EditAnywhere, Category = "Input Buffer")
+	TArray<FKey> Keys;
+};
+
+USTRUCT(BlueprintType)
+struct FBufferedInputEventKeyMapping
+{
+	GENERATED_BODY()
+
+	FBufferedInputEventKeyMapping() : Name(NAME_None) {}
+
+	/** Name of this mapping. */
+	UPROPERTY(EditAnywhere, Category = "Input Buffer")
+	FName Name;
+
+	/** Keys to bind it to. */
+	UPROPERTY(EditAnywhere, Category = "Input Buffer")
+	TArray<FKey> Keys;
+};
+
+/**
+* A 2D axis, e.g. an analog stick, quantized into eight direction events named after the stick, e.g. "MoveUp", "MoveUpRight", ... "MoveUpLeft".
+* A direction event behaves like an event bound to a single key which is down while the stick points in that direction.
+**/
+USTRUCT(BlueprintType)
+struct FBufferedInputStickSetup
+{
+	GENERATED_BODY()
+
+	FBufferedInputStickSetup()
+		: bEnabled(true)
+		, Name(NAME_None)
+		, Type(EBufferedInputEventType::Pressed)
+		, bExecuteWhenPaused(false)
+		, DeadZone(0.3f)
+		, DeadZoneHysteresis(0.05f)
+		, AngleHysteresis(7.5f)
+	{}
+
+	/** Whether this stick is enabled. */
+	UPROPERTY(EditAnywhere, Category = "Input Buffer")
+	bool bEnabled;
+
+	/** Prefix of the direction events, e.g "Move" */
+	UPROPERTY(EditAnywhere, Category = "Input Buffer")
+	FName Name;
+
+	/** Type of the direction events. */
+	UPROPERTY(EditAnywhere, Category = "Input Buffer")
+	EBufferedInputEventType Type;
+
+	/** Should the direction events get triggered even when the game is paused? */
+	UPROPERTY(EditAnywhere, Category = "Input Buffer")
+	bool bExecuteWhenPaused;
+
+	/** Horizontal axis, positive to the right. */
+	UPROPERTY(EditAnywhere, Category = "Input Buffer")
+	FKey XAxis;
+
+	/** Vertical axis, positive upwards. */
+	UPROPERTY(EditAnywhere, Category = "Input Buffer")
+	FKey YAxis;
+
+	/** The stick points in a direction once it is pushed beyond this magnitude. */
+	UPROPERTY(EditAnywhere, Category = "Input Buffer", Meta = (ClampMin = 0, ClampMax = 1))
+	float DeadZone;
+
+	/** The stick returns to neutral only once its magnitude falls below DeadZone minus this much. */
+	UPROPERTY(EditAnywhere, Category = "Input Buffer", Meta = (ClampMin = 0, ClampMax = 1))
+	float DeadZoneHysteresis;
+
+	/** Degrees the stick must pass the border between two directions before the direction changes. */
+	UPROPERTY(EditAnywhere, Category = "Input Buffer", Meta = (ClampMin = 0, ClampMax = 22.5))
+	float AngleHysteresis;
+};
+
+/**
+* A stick compiled for input buffers. Its direction events and the virtual keys behind them are consecutive, in the order of Right, UpRight, Up, ... DownRight.
+**/
+struct INPUTBUFFER_API FCompiledInputStick
+{
+	static const int32 NUM_DIRECTIONS = 8;
+
+	/**
+	* Quantizes a stick position into a direction.
+	*
+	* @param Direction The current direction, or INDEX_NONE if the stick is neutral.
+	* @return The new direction, or INDEX_NONE if the stick is neutral.
+	*/
+	int32 Quantize(float X, float Y, int32 Direction) const;
+
+	FKey XAxis;
+	FKey YAxis;
+
+	float DeadZone;
+	float ReleaseDeadZone;
+	float AngleHysteresis;
+
+	/* Index of the first direction event. */
+	int32 FirstEvent;
+
+	/* Index of the first virtual key, after all the bound keys. */
+	int32 FirstKey;
+};
+
+/**
+* Input events, keys and commands compiled for input buffers. Immutable once compiled, so it is shared by reference between input buffers using the same schema.
+**/
+struct INPUTBUFFER_API FCompiledInputBufferSchema
+{
+	FCompiledInputBufferSchema() : NumKeyWords(0) {}
+
+	/**
+	* Compiles input event set-ups and commands.
+	*
+	* @param Commands Input commands to compile against the compiled events.
+	*/
+	static TSharedRef<FCompiledInputBufferSchema> Compile(const TArray<FBufferedInputEventSetup>& EventSetups, const TArray<FBufferedInputStickSetup>& StickSetups,
+		const TArray<FName>& TranslatedEvents, const TArray<FBufferedInputEventKeyMapping>& KeyMappings, const TArray<class UInputCommand*>& Commands);
+
+	/* Registered input events. An event's index in this array is its bit in event flags. */
+	TArray<FBufferedInputEventSetup> Events;
+
+	/* Names of registered input events as strings, for debug output without conversions. */
+	TArray<FString> EventNameStrings;
+
+	TMap<FName, int32> EventIndexMap;
+
+	/* Keys bound to events. A key's index in this array is its bit in key states. */
+	TArray<FKey> Keys;
+
+	TMap<FKey, int32> KeyIndexMap;
+
+	/* Sticks whose directions are virtual keys following Keys. */
+	TArray<FCompiledInputStick> Sticks;
+
+	/* The number of 64-bit words holding the state of all keys, virtual ones included. */
+	int32 NumKeyWords;
+
+	/* Bits of the keys bound to each event, NumKeyWords words per event. */
+	TArray<uint64> EventKeyMasks;
+
+	/* Events which can be raised while the game is paused. */
+	FInputEventFlags PausedEventMask;
+
+	/* Commands compiled against EventIndexMap. */
+	TMap<TWeakObjectPtr<const class UInputCommand>, FCompiledInputCommand> Commands;
+};
+
+/**
+* Input event set-up shared by input buffers, so that it is compiled only once and input buffers do not hold a copy of it.
+**/
+UCLASS(BlueprintType, ClassGroup=(Input))
+class INPUTBUFFER_API UInputBufferSchema : public UDataAsset
+{
+	GENERATED_BODY()
+
+public:
+
+	/* Input events set-up information. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Input Buffer")
+	TArray<FBufferedInputEventSetup> EventSetups;
+
+	/* Analog sticks quantized into direction events. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Input Buffer")
+	TArray<FBufferedInputStickSetup> StickSetups;
+
+	/* A list of input events into which others could be translated. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Input Buffer")
+	TArray<FName> TranslatedEvents;
+
+	/* Optional key mappings that can be referenced in input event set-up. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Input Buffer")
+	TArray<FBufferedInputEventKeyMapping> KeyMappings;
+
+	/* Input commands compiled together with the schema, so that input buffers using it do not compile them again. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Input Buffer")
+	TArray<class UInputCommand*> Commands;
+
+public:
+
+	/* Returns the compiled schema. It is compiled on first use. */
+	TSharedRef<const FCompiledInputBufferSchema> GetCompiledSchema() const;
+
+	/**
+	* Discards the compiled schema so that it is compiled again on next use. Should be called after changes to the schema are made at runtime.
+	*
+	* Caution: Input buffers keep using the old one until they are initialized again.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Input Buffer")
+	void InvalidateCompiledSchema();
+
+#if WITH_EDITOR
+	//~ Begin UObject Interface
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+	//~ End UObject Interface
+#endif
+
+protected:
+
+	mutable TSharedPtr<const FCompiledInputBufferSchema> CompiledSchema;
+};
@@ -113,6 +113,10 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Input Command")
 	TArray<FInputCommandSequence> Sequences;
 
+	/* If true, the input records used by a match are consumed when this command is recognized as a watched command, so that they cannot trigger other commands. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Input Command")
+	bool bConsumeInput;
+
 #if WITH_EDITORONLY_DATA
 	/* If specified, use this texture for the thumbnail. */
 	UPROPERTY(EditAnywhere, Category = "Thumbnail")
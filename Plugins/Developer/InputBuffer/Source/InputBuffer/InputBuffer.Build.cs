@@ -29,6 +29,9 @@ public class InputBuffer : ModuleRules
             "SlateCore",
         });
 
+        // Capacity of input events. Must be a multiple of 64; wider flags cost a little more per comparison.
+        PublicDefinitions.Add("INPUTBUFFER_MAX_EVENTS=64");
+
         // ... add any modules that your module loads dynamically here ...
         DynamicallyLoadedModuleNames.AddRange(new string[] {});
 	}
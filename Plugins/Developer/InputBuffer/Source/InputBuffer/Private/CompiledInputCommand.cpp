@@ -0,0 +1,188 @@
+// Copyright 2018 Isaac Hsu.
+
+#include "CompiledInputCommand.h"
+
+#include "BufferedInputEventKit.h"
+#include "InputCommand.h"
+
+namespace CompiledInputCommand
+{
+	/* Sets bits of given events. Returns false if any of them is unknown. */
+	static bool ConvertEventsToFlags(const TArray<FName>& Events, const TMap<FName, int32>& EventIndexMap, FInputEventFlags& Flags)
+	{
+		bool bSucceeded = true;
+		for (FName Event : Events)
+		{
+			const int32* Index = EventIndexMap.Find(Event);
+			if (Index)
+			{
+				Flags.SetBit(*Index);
+			}
+			else
+			{
+				bSucceeded = false;
+			}
+		}
+
+		return bSucceeded;
+	}
+}
+
+void FCompiledInputCommand::Compile(const UInputCommand& Command, const TMap<FName, int32>& EventIndexMap)
+{
+	TimeLimit = Command.TimeLimit;
+	bConsumeInput = Command.bConsumeInput;
+	Entries.Reset();
+	Sequences.Reset(Command.Sequences.Num());
+
+	FInputEventFlags OuterIgnoreFlags;
+	CompiledInputCommand::ConvertEventsToFlags(Command.EventsToIgnore, EventIndexMap, OuterIgnoreFlags);
+
+	for (const FInputCommandSequence& Sequence : Command.Sequences)
+	{
+		if (!Sequence.bEnabled)
+		{
+			continue;
+		}
+
+		FCompiledInputCommandSequence CompiledSequence;
+		CompiledSequence.FirstEntry = Entries.Num();
+		CompiledSequence.NumEntries = Sequence.Entries.Num();
+
+		bool bKnownEvents = true;
+		for (const FInputCommandEntry& Entry : Sequence.Entries)
+		{
+			FCompiledInputCommandEntry& CompiledEntry = Entries.AddDefaulted_GetRef();
+
+			// For events to match, unknown events means mismatch. But for events to ignore, unknown events are omitted.
+			if (!CompiledInputCommand::ConvertEventsToFlags(Entry.EventsToMatch, EventIndexMap, CompiledEntry.MatchFlags))
+			{
+				bKnownEvents = false;
+				break;
+			}
+			CompiledInputCommand::ConvertEventsToFlags(Entry.EventsToIgnore, EventIndexMap, CompiledEntry.IgnoreFlags);
+
+			CompiledEntry.bIgnoreOthers = Entry.bIgnoreOthers;
+			if (!Entry.bIgnoreOthers)
+			{
+				CompiledEntry.IgnoreFlags |= OuterIgnoreFlags;
+			}
+
+			CompiledEntry.MinDuration = Entry.MinDuration;
+			CompiledEntry.MaxDuration = Entry.MaxDuration;
+			CompiledEntry.MinInterval = Entry.MinInterval;
+			CompiledEntry.MaxInterval = Entry.MaxInterval;
+		}
+
+		if (bKnownEvents)
+		{
+			Sequences.Add(CompiledSequence);
+		}
+		else
+		{
+			// A sequence with unknown events can never match, so drop it.
+			Entries.SetNum(CompiledSequence.FirstEntry, false);
+		}
+	}
+}
+
+EInputCommandMatchResult FInputCommandMatchState::Step(const FCompiledInputCommandEntry* Entries, float TimeLimit, const FInputBufferRecord& Record, float CurrTime)
+{
+	if (EntryIdx < 0)
+	{
+		return EInputCommandMatchResult::Matched; // because of nothing to match
+	}
+
+	if (!Record.bValid)
+	{
+		return Finish(Entries); // Need not check the previous records since they should be invalid too.
+	}
+
+	// The same record may be tried with several entries, but each iteration either consumes the record or moves to the next entry.
+	for (;;)
+	{
+		const FCompiledInputCommandEntry& Entry = Entries[EntryIdx];
+
+		if (CurrTime - Record.EndTime > TimeLimit && TimeLimit != 0.f && !bRepeating)
+		{
+			return EInputCommandMatchResult::Failed;
+		}
+
+		const bool bMatched = Entry.bIgnoreOthers // Whether the current record matches the current entry?
+			? FBufferedInputEventKit::HasEventFlags(Record.Events, Entry.MatchFlags)
+			: FBufferedInputEventKit::CompareEventFlags(Record.Events, Entry.MatchFlags, Entry.IgnoreFlags);
+
+		if (bMatched)
+		{
+			if (CurrEntryEndTime == 0)
+			{
+				// Check limits of the duration of the previous entry.
+				if (PrevEntryEndTime != 0.f)
+				{
+					const FCompiledInputCommandEntry& PrevEntry = Entries[EntryIdx + 1];
+					if (!PrevEntry.CheckDuration(PrevEntryEndTime - PrevEntryStartTime))
+					{
+						return EInputCommandMatchResult::Failed;
+					}
+				}
+
+				// Check limits of the internal between the current entry and previous entry.
+				if (PrevEntryStartTime != 0.f && !Entry.CheckInterval(PrevEntryStartTime - Record.EndTime))
+				{
+					return EInputCommandMatchResult::Failed;
+				}
+
+				CurrEntryEndTime = Record.EndTime;
+			}
+			CurrEntryStartTime = Record.StartTime;
+
+			bRepeating = true;
+			return EInputCommandMatchResult::Pending;
+		}
+		else if (bRepeating)
+		{
+			if (EntryIdx == 0)
+			{
+				// Even if we failed to repeat the first entry, command recognition still succeeds since we have found matching records for all entries.
+				return Entry.CheckDuration(CurrEntryEndTime - CurrEntryStartTime) ? EInputCommandMatchResult::Matched : EInputCommandMatchResult::Failed;
+			}
+
+			bRepeating = false;
+			if (CurrEntryEndTime != 0)
+			{
+				PrevEntryStartTime = CurrEntryStartTime;
+				PrevEntryEndTime = CurrEntryEndTime;
+				CurrEntryStartTime = 0.f;
+				CurrEntryEndTime = 0.f;
+			}
+
+			EntryIdx--; // Try the same record with the next entry.
+		}
+		else if (Record.Events.IsZero() || Entry.bIgnoreOthers || Record.Events.IsSubsetOf(Entry.IgnoreFlags))
+		{
+			// Skip the current record when there is no input, or the input events do not match but are all neglectable.
+			return EInputCommandMatchResult::Pending;
+		}
+		else
+		{
+			return EInputCommandMatchResult::Failed; // Fails due to mismatch.
+		}
+	}
+}
+
+EInputCommandMatchResult FInputCommandMatchState::Finish(const FCompiledInputCommandEntry* Entries) const
+{
+	if (EntryIdx < 0)
+	{
+		return EInputCommandMatchResult::Matched;
+	}
+
+	// Succeeds only if we are repeating the first entry, which means all the other entries have been matched.
+	if (EntryIdx == 0 && bRepeating && Entries[0].CheckDuration(CurrEntryEndTime - CurrEntryStartTime))
+	{
+		return EInputCommandMatchResult::Matched;
+	}
+
+	return EInputCommandMatchResult::Failed;
+}
+
@@ -4,10 +4,25 @@
 
 #include "Engine/World.h"
 #include "GameFramework/PlayerInput.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
 #include "KeyState.h"
+#include "Misc/Paths.h"
+#include "ProfilingDebugging/MiscTrace.h"
 
 #include "InputBufferPlayerController.h"
+#include "InputBufferSchema.h"
+#include "InputBufferSnapshot.h"
 #include "InputCommand.h"
+#include "InputCommandSetMatcher.h"
+
+/* Press and release time of events which never went down or up. */
+static const float NeverTime = -MAX_flt;
+
+static TAutoConsoleVariable<int32> CVarInputBufferTraceTimeline(
+	TEXT("InputBuffer.TraceTimeline"),
+	0,
+	TEXT("If non-zero, every buffered input event is marked with a trace bookmark, so that input timing can be viewed next to frame timing in Insights."));
 
 //////////////////////////////////////////////////////////////////////////
 // UInputBufferComponent
@@ -16,6 +31,23 @@
 UInputBufferComponent::UInputBufferComponent()
 {
 	MaxInputHistory = 10;
+	bCaptureKeyEvents = false;
+	LastTimeSample = 0.f;
+	LastPlatformTimeSample = 0.0;
+	bNativeEventTranslation = false;
+	Schema = nullptr;
+
+	RuntimeSchema = MakeShared<FCompiledInputBufferSchema>();
+	PreviousKeyStates = &KeyStates1;
+	CurrentKeyStates = &KeyStates2;
+
+	SnapshotSize = 0;
+
+	PublishedEventTimes.Time = 0.f;
+
+	ReplayStartTime = 0.f;
+	bHasReplayFrame = false;
+	ReplayFrameTime = 0.0;
 }
 
 void UInputBufferComponent::BeginPlay()
@@ -25,112 +57,62 @@ void UInputBufferComponent::BeginPlay()
 	Initialize();
 }
 
-int32 UInputBufferComponent::Initialize()
+void UInputBufferComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
-	RuntimeEvents.Reset(EventSetups.Num() + TranslatedEvents.Num());
-	EventIndexMap.Empty(RuntimeEvents.Num());
-    KeyIndexMap.Reset();
+	StopRecording();
+	StopReplay();
+
+	Super::EndPlay(EndPlayReason);
+}
 
-	KeyStates1.Reset();
-	KeyStates2.Reset();
+int32 UInputBufferComponent::Initialize()
+{
+	// Recordings refer to the old event indices.
+	StopRecording();
+	StopReplay();
 
-	TMap<FName, int32> KeyMappingIndexMap;
-	for (int Idx = 0; Idx < KeyMappings.Num(); Idx++)
+	// A shared schema is compiled once for all the input buffers using it.
+	if (Schema)
 	{
-		auto& Mapping = KeyMappings[Idx];
-		if (Mapping.Name != NAME_None && Mapping.Keys.Num() > 0 && KeyMappingIndexMap.Find(Mapping.Name) == nullptr)
-		{
-			KeyMappingIndexMap.Add(Mapping.Name, Idx);
-		}
+		RuntimeSchema = Schema->GetCompiledSchema();
 	}
-
-	for (const auto& Setup : EventSetups)
+	else
 	{
-		if (Setup.bEnabled && Setup.Name != NAME_None && EventIndexMap.Find(Setup.Name) == nullptr)
-		{
-			if (RuntimeEvents.Num() >= FInputBufferRecord::MAX_EVENTS)
-			{
-				UE_LOG(InputBufferLog, Warning, TEXT("Cannot register input events more than %d."), FInputBufferRecord::MAX_EVENTS);
-				break;
-			}
-
-			// The use of a set makes sure there will be no duplicate keys.
-			TSet<FKey> KeySet;
-
-			for (const FKey& Key : Setup.Keys)
-			{
-				if (Key.IsValid())
-				{
-					KeySet.Add(Key);
-				}
-			}
-
-			if (Setup.KeyMappingName != NAME_None)
-			{
-				int32* Index = KeyMappingIndexMap.Find(Setup.KeyMappingName);
-				if (Index)
-				{
-					for (const FKey& Key : KeyMappings[*Index].Keys)
-					{
-						if (Key.IsValid())
-						{
-							KeySet.Add(Key);
-						}
-					}
-				}
-			}
+		RuntimeSchema = FCompiledInputBufferSchema::Compile(EventSetups, StickSetups, TranslatedEvents, KeyMappings, TArray<UInputCommand*>());
+	}
 
-			if (KeySet.Num() > 0)
-			{
-				for (FKey& Key : KeySet)
-				{
-					if (KeyIndexMap.Find(Key) == nullptr)
-					{
-						int32 Index1 = KeyStates1.Add(false);
-						int32 Index2 = KeyStates2.Add(false);
-						check(Index1 == Index2);
-						KeyIndexMap.Add(Key, Index1);
-					}
-				}
+	const int32 NumKeyWords = RuntimeSchema->NumKeyWords;
+	const int32 NumEvents = RuntimeSchema->Events.Num();
+	KeyStates1.Init(0, NumKeyWords);
+	KeyStates2.Init(0, NumKeyWords);
+	KeyEdges.Init(0, NumKeyWords * 3);
+	EventsDown = FInputEventFlags();
+	EventPressTimes.Init(NeverTime, NumEvents);
+	EventReleaseTimes.Init(NeverTime, NumEvents);
+	PublishEventTimes(true);
 
-				int32 Index = RuntimeEvents.Add(Setup);
-				EventIndexMap.Add(Setup.Name, Index);
-				RuntimeEvents[Index].Keys = KeySet.Array();
-			}
-			else
-			{
-				UE_LOG(InputBufferLog, Warning, TEXT("Input event '%s' does not have any valid key mappings."), *Setup.Name.ToString());
-			}
-		}
-	}
+	PreviousKeyStates = &KeyStates1;
+	CurrentKeyStates = &KeyStates2;
 
-	for (FName Event : TranslatedEvents)
+	ResetEventTranslations();
+	if (bNativeEventTranslation)
 	{
-		if (Event != NAME_None && EventIndexMap.Find(Event) == nullptr)
+		if (auto Controller = Cast<AInputBufferPlayerController>(GetOwner()))
 		{
-			if (RuntimeEvents.Num() >= FInputBufferRecord::MAX_EVENTS)
-			{
-				UE_LOG(InputBufferLog, Warning, TEXT("Cannot register input events more than %d."), FInputBufferRecord::MAX_EVENTS);
-				break;
-			}
-
-			FBufferedInputEventSetup Setup;
-			Setup.Name = Event;
-			int32 Index = RuntimeEvents.Add(Setup);
-			EventIndexMap.Add(Setup.Name, Index);
+			Controller->RefreshEventTranslations();
 		}
 	}
 
-	check(KeyStates1.Num() == KeyStates2.Num());
-
-	PreviousKeyStates = &KeyStates1;
-	CurrentKeyStates = &KeyStates2;
-
     CurrentRecord = FInputBufferRecord();
+	QueuedKeyEvents.Reset();
 
 	InputHistory.Reset(MaxInputHistory);
 
-	return EventIndexMap.Num();
+	// Compiled commands refer to the old event indices.
+	CompiledCommands.Reset();
+	RebuildRecognizer();
+
+	return RuntimeSchema->EventIndexMap.Num();
 }
 
 void UInputBufferComponent::OnPreProcessInput(UPlayerInput* PlayerInput, const bool bGamePaused)
@@ -142,118 +124,350 @@ void UInputBufferComponent::OnPostProcessInput(UPlayerInput* PlayerInput, const
 	ProcessInput(PlayerInput, bGamePaused);
 }
 
+void UInputBufferComponent::OnInputKey(const FKey& Key, EInputEvent EventType)
+{
+	if (!bCaptureKeyEvents)
+	{
+		return;
+	}
+
+	// Repeats and axis changes do not change key states.
+	const bool bDown = EventType == IE_Pressed || EventType == IE_DoubleClick;
+	if (!bDown && EventType != IE_Released)
+	{
+		return;
+	}
+
+	int32* KeyIndex = RuntimeSchema->KeyIndexMap.Find(Key);
+	if (KeyIndex)
+	{
+		FQueuedKeyEvent& KeyEvent = QueuedKeyEvents.AddDefaulted_GetRef();
+		KeyEvent.KeyIndex = *KeyIndex;
+		KeyEvent.bDown = bDown;
+		KeyEvent.Timestamp = FPlatformTime::Seconds();
+	}
+}
+
 void UInputBufferComponent::ProcessInput(UPlayerInput* PlayerInput, const bool bGamePaused)
 {
-	// Reset the current record because we may add it to the input buffer later.
-	CurrentRecord.bValid = true;
-	CurrentRecord.StartTime = GetCurrentTime();
-	CurrentRecord.EndTime = CurrentRecord.StartTime;
-	CurrentRecord.Events = 0;
-	CurrentRecord.TranslatedEvents = 0;
+	const float CurrTime = GetCurrentTime();
 
 	auto Controller = Cast<AInputBufferPlayerController>(GetOwner());
 
+	if (ReplayReader)
+	{
+		// Recorded input replaces player input.
+		QueuedKeyEvents.Reset();
+		SampleClocks(CurrTime);
+		ProcessReplay(CurrTime, Controller);
+		return;
+	}
+
+	if (PlayerInput && QueuedKeyEvents.Num() > 0)
+	{
+		ProcessQueuedKeyEvents(CurrTime, bGamePaused, Controller);
+	}
+	QueuedKeyEvents.Reset();
+	SampleClocks(CurrTime);
+
+	// Reset the current record because we may add it to the input buffer later.
+	BeginRecord(CurrTime);
+
 	if (PlayerInput)
 	{
 		Swap(PreviousKeyStates, CurrentKeyStates);
 
-		// Update key states so we can determine if a key is just pressed or released.
-		for (const auto& Pair : KeyIndexMap)
+		// Update key states so we can determine if a key is just pressed or released. Transitions missed by key capture are caught here as well.
+		const TArray<FKey>& Keys = RuntimeSchema->Keys;
+		uint64* CurrWords = CurrentKeyStates->GetData();
+		FMemory::Memzero(CurrWords, RuntimeSchema->NumKeyWords * sizeof(uint64));
+		for (int32 KeyIdx = 0; KeyIdx < Keys.Num(); KeyIdx++)
 		{
-			FKeyState* State = PlayerInput->GetKeyState(Pair.Key);
-			(*CurrentKeyStates)[Pair.Value] = State ? (State->bDown != 0) : false;
+			FKeyState* State = PlayerInput->GetKeyState(Keys[KeyIdx]);
+			CurrWords[KeyIdx >> 6] |= (uint64)(State && State->bDown) << (KeyIdx & 63);
 		}
 
-		// Set event flags according key states
-		for (int32 Idx = 0; Idx < RuntimeEvents.Num(); Idx++)
+		// Stick directions are virtual keys, quantized against the previous direction for hysteresis.
+		const uint64* PrevWords = PreviousKeyStates->GetData();
+		for (const FCompiledInputStick& Stick : RuntimeSchema->Sticks)
 		{
-			const auto& Event = RuntimeEvents[Idx];
-
-			if (!bGamePaused || Event.bExecuteWhenPaused)
+			int32 Direction = INDEX_NONE;
+			for (int32 Dir = 0; Dir < FCompiledInputStick::NUM_DIRECTIONS; Dir++)
 			{
-				if (Event.Type == EBufferedInputEventType::Pressed)
-				{
-					for (const FKey& Key : Event.Keys)
-					{
-						int32* KeyIndex = KeyIndexMap.Find(Key);
-						if (KeyIndex)
-						{
-							if (!(*PreviousKeyStates)[*KeyIndex] && (*CurrentKeyStates)[*KeyIndex])
-							{
-								RecordEvent(Idx, Controller);
-								break;
-							}
-						}
-					}
-				}
-				else if (Event.Type == EBufferedInputEventType::Released)
-				{
-					for (const FKey& Key : Event.Keys)
-					{
-						int32* KeyIndex = KeyIndexMap.Find(Key);
-						if (KeyIndex)
-						{
-							if ((*PreviousKeyStates)[*KeyIndex] && !(*CurrentKeyStates)[*KeyIndex])
-							{
-								RecordEvent(Idx, Controller);
-								break;
-							}
-						}
-					}
-				}
-				else if (Event.Type == EBufferedInputEventType::Held)
+				const int32 KeyIdx = Stick.FirstKey + Dir;
+				if (PrevWords[KeyIdx >> 6] & (1ULL << (KeyIdx & 63)))
 				{
-					for (const FKey& Key : Event.Keys)
-					{
-						int32* KeyIndex = KeyIndexMap.Find(Key);
-						if (KeyIndex)
-						{
-							if ((*CurrentKeyStates)[*KeyIndex])
-							{
-								RecordEvent(Idx, Controller);
-								break;
-							}
-						}
-					}
+					Direction = Dir;
 				}
 			}
+
+			Direction = Stick.Quantize(PlayerInput->GetKeyValue(Stick.XAxis), PlayerInput->GetKeyValue(Stick.YAxis), Direction);
+			if (Direction != INDEX_NONE)
+			{
+				const int32 KeyIdx = Stick.FirstKey + Direction;
+				CurrWords[KeyIdx >> 6] |= 1ULL << (KeyIdx & 63);
+			}
 		}
+
+		RecordEvents(ComputeRaisedEvents(bGamePaused), Controller);
 	}
 
+	CommitRecord(Controller);
+}
+
+void UInputBufferComponent::ProcessEvents(const FInputEventFlags& Events, float Time)
+{
+	auto Controller = Cast<AInputBufferPlayerController>(GetOwner());
+
+	BeginRecord(Time);
+	RecordEvents(Events, Controller);
+	CommitRecord(Controller);
+}
+
+void UInputBufferComponent::ProcessQueuedKeyEvents(float CurrTime, const bool bGamePaused, AInputBufferPlayerController* Controller)
+{
+	// Map platform timestamps onto the clock of the input buffer, and keep records in chronological order.
+	// The clock may run slower or faster than real time (e.g. time dilation in an overridden GetCurrentTime), so platform intervals are scaled by its rate over the last frame.
+	const double PlatformTime = FPlatformTime::Seconds();
+	double ClockRate = 1.0;
+	if (LastPlatformTimeSample > 0.0 && PlatformTime > LastPlatformTimeSample)
+	{
+		ClockRate = FMath::Max((CurrTime - LastTimeSample) / (PlatformTime - LastPlatformTimeSample), 0.0);
+	}
+	float MinTime = InputHistory.Num() > 0 ? FMath::Min(InputHistory.GetEndTime(InputHistory.Num() - 1), CurrTime) : TNumericLimits<float>::Lowest();
+
+	for (const FQueuedKeyEvent& KeyEvent : QueuedKeyEvents)
+	{
+		const uint64 KeyBit = 1ULL << (KeyEvent.KeyIndex & 63);
+		const int32 WordIdx = KeyEvent.KeyIndex >> 6;
+		if ((((*CurrentKeyStates)[WordIdx] & KeyBit) != 0) == KeyEvent.bDown)
+		{
+			continue;
+		}
+
+		Swap(PreviousKeyStates, CurrentKeyStates);
+		FMemory::Memcpy(CurrentKeyStates->GetData(), PreviousKeyStates->GetData(), RuntimeSchema->NumKeyWords * sizeof(uint64));
+		(*CurrentKeyStates)[WordIdx] ^= KeyBit;
+
+		const float Time = FMath::Clamp((float)(CurrTime + (KeyEvent.Timestamp - PlatformTime) * ClockRate), MinTime, CurrTime);
+		MinTime = Time;
+
+		BeginRecord(Time);
+		RecordEvents(ComputeRaisedEvents(bGamePaused), Controller);
+		CommitRecord(Controller);
+	}
+}
+
+void UInputBufferComponent::SampleClocks(float CurrTime)
+{
+	LastTimeSample = CurrTime;
+	LastPlatformTimeSample = FPlatformTime::Seconds();
+}
+
+void UInputBufferComponent::BeginRecord(float Time)
+{
+	CurrentRecord.bValid = true;
+	CurrentRecord.StartTime = Time;
+	CurrentRecord.EndTime = Time;
+	CurrentRecord.Events = FInputEventFlags();
+	CurrentRecord.TranslatedEvents = FInputEventFlags();
+}
+
+void UInputBufferComponent::CommitRecord(AInputBufferPlayerController* Controller)
+{
 	// Add the current record to the input buffer if the input events are different from the previous. Otherwise, just prolong the last record.
-	FInputBufferRecord* LastRecord = InputHistory.Last();
-	if (LastRecord && LastRecord->Events == CurrentRecord.Events && LastRecord->TranslatedEvents == CurrentRecord.TranslatedEvents)
+	const int32 LastIndex = InputHistory.Num() - 1;
+	if (LastIndex != INDEX_NONE && InputHistory.GetEvents(LastIndex) == CurrentRecord.Events && InputHistory.GetTranslatedEvents(LastIndex) == CurrentRecord.TranslatedEvents)
 	{
-		LastRecord->EndTime = CurrentRecord.StartTime;
+		InputHistory.SetLastEndTime(CurrentRecord.StartTime);
+		Recognizer.ExtendRecord(InputHistory.GetRecord(LastIndex));
 	}
-	else
+	else if (InputHistory.Push(CurrentRecord) != INDEX_NONE)
 	{
-		InputHistory.Push(CurrentRecord);
+		Recognizer.PushRecord(CurrentRecord, InputHistory.Num(), InputHistory.GetRecord(0));
+
+		if (CVarInputBufferTraceTimeline.GetValueOnGameThread())
+		{
+			const TArray<FString>& Names = RuntimeSchema->EventNameStrings;
+			CurrentRecord.Events.ForEachSetBit([&Names](int32 EventIdx)
+			{
+				TRACE_BOOKMARK(TEXT("Input %s"), *Names[EventIdx]);
+			});
+
+			// Events translated away are marked separately, under their original names.
+			CurrentRecord.TranslatedEvents.ForEachSetBit([&Names](int32 EventIdx)
+			{
+				TRACE_BOOKMARK(TEXT("Input %s (translated)"), *Names[EventIdx]);
+			});
+		}
+	}
+
+	PublishEventTimes(false);
+
+	if (Recorder)
+	{
+		Recorder->WriteFrame(CurrentRecord.Events, CurrentRecord.TranslatedEvents, CurrentRecord.StartTime);
 	}
 
+	UpdateRecognizedCommands(CurrentRecord.StartTime, true);
+
 	// Trigger PostBufferInput event when the current events are not empty.
-	if (CurrentRecord.Events != 0 && Controller)
+	if (!CurrentRecord.Events.IsZero() && Controller)
 	{
 		Controller->PostBufferInput();
 	}
 }
 
-void UInputBufferComponent::RecordEvent(uint64 EventIndex, AInputBufferPlayerController* Controller)
+FInputEventFlags UInputBufferComponent::ComputeRaisedEvents(const bool bGamePaused)
+{
+	const FCompiledInputBufferSchema& Compiled = *RuntimeSchema;
+	const int32 NumKeyWords = Compiled.NumKeyWords;
+
+	const uint64* PrevWords = PreviousKeyStates->GetData();
+	const uint64* CurrWords = CurrentKeyStates->GetData();
+	uint64* Pressed = KeyEdges.GetData();
+	uint64* Released = Pressed + NumKeyWords;
+	uint64* Held = Released + NumKeyWords;
+
+	for (int32 WordIdx = 0; WordIdx < NumKeyWords; WordIdx++)
+	{
+		const uint64 Changed = PrevWords[WordIdx] ^ CurrWords[WordIdx];
+		Pressed[WordIdx] = Changed & CurrWords[WordIdx];
+		Released[WordIdx] = Changed & PrevWords[WordIdx];
+		Held[WordIdx] = CurrWords[WordIdx];
+	}
+
+	// An event is raised if any of its keys has the edge selected by the event type, and held if any of its keys is down.
+	FInputEventFlags Raised;
+	FInputEventFlags Down;
+	const uint64* Mask = Compiled.EventKeyMasks.GetData();
+	for (int32 EventIdx = 0; EventIdx < Compiled.Events.Num(); EventIdx++, Mask += NumKeyWords)
+	{
+		const uint64* Edges = KeyEdges.GetData() + (int32)Compiled.Events[EventIdx].Type * NumKeyWords;
+		uint64 Any = 0;
+		uint64 AnyDown = 0;
+		for (int32 WordIdx = 0; WordIdx < NumKeyWords; WordIdx++)
+		{
+			Any |= Edges[WordIdx] & Mask[WordIdx];
+			AnyDown |= Held[WordIdx] & Mask[WordIdx];
+		}
+		Raised.Words[EventIdx >> 6] |= (uint64)(Any != 0) << (EventIdx & 63);
+		Down.Words[EventIdx >> 6] |= (uint64)(AnyDown != 0) << (EventIdx & 63);
+	}
+
+	const FInputEventFlags Changed = Down ^ EventsDown;
+	if (!Changed.IsZero())
+	{
+		(Changed & Down).ForEachSetBit([this](int32 EventIdx) { EventPressTimes[EventIdx] = CurrentRecord.StartTime; });
+		(Changed & EventsDown).ForEachSetBit([this](int32 EventIdx) { EventReleaseTimes[EventIdx] = CurrentRecord.StartTime; });
+		EventsDown = Down;
+	}
+
+	if (bGamePaused)
+	{
+		Raised &= Compiled.PausedEventMask;
+	}
+
+	return Raised;
+}
+
+void UInputBufferComponent::RecordEvents(const FInputEventFlags& Events, AInputBufferPlayerController* Controller)
+{
+	if (!bNativeEventTranslation)
+	{
+		Events.ForEachSetBit([this, Controller](int32 EventIndex)
+		{
+			RecordEvent(EventIndex, Controller);
+		});
+		return;
+	}
+
+	// Untranslated events are recorded as they are, and translated ones are recorded as original events and mapped to their targets.
+	const FInputEventFlags Translated = Events & TranslatedEventMask;
+	CurrentRecord.Events |= Events & ~TranslatedEventMask;
+	CurrentRecord.TranslatedEvents |= Translated;
+
+	Translated.ForEachSetBit([this](int32 EventIndex)
+	{
+		const int32 Target = TranslationTargets[EventIndex];
+		if (Target != INDEX_NONE)
+		{
+			CurrentRecord.Events.SetBit(Target);
+		}
+	});
+}
+
+bool UInputBufferComponent::SetEventTranslation(FName Event, FName TranslatedEvent)
+{
+	const int32* EventIndex = RuntimeSchema->EventIndexMap.Find(Event);
+	if (EventIndex == nullptr)
+	{
+		return false;
+	}
+
+	if (Event == TranslatedEvent)
+	{
+		TranslationTargets[*EventIndex] = *EventIndex;
+		TranslatedEventMask.ClearBit(*EventIndex);
+		return true;
+	}
+
+	TranslatedEventMask.SetBit(*EventIndex);
+
+	if (TranslatedEvent == NAME_None)
+	{
+		TranslationTargets[*EventIndex] = INDEX_NONE; // Skip event flag recording
+		return true;
+	}
+
+	const int32* TargetIndex = RuntimeSchema->EventIndexMap.Find(TranslatedEvent);
+	if (TargetIndex == nullptr)
+	{
+		// Same as RecordEvent, the original event is recorded.
+		UE_LOG(InputBufferLog, Warning, TEXT("Unknown input event '%s' translated from '%s'."), *TranslatedEvent.ToString(), *Event.ToString());
+		TranslationTargets[*EventIndex] = *EventIndex;
+		return false;
+	}
+
+	TranslationTargets[*EventIndex] = *TargetIndex;
+	return true;
+}
+
+void UInputBufferComponent::ResetEventTranslations()
+{
+	TranslationTargets.SetNumUninitialized(RuntimeSchema->Events.Num());
+	for (int32 Idx = 0; Idx < RuntimeSchema->Events.Num(); Idx++)
+	{
+		TranslationTargets[Idx] = Idx;
+	}
+
+	TranslatedEventMask = FInputEventFlags();
+}
+
+void UInputBufferComponent::UpdateEventTranslations(TFunctionRef<FName(FName)> Translate)
+{
+	for (const auto& Event : RuntimeSchema->Events)
+	{
+		SetEventTranslation(Event.Name, Translate(Event.Name));
+	}
+}
+
+void UInputBufferComponent::RecordEvent(int32 EventIndex, AInputBufferPlayerController* Controller)
 {
-	check(EventIndex < RuntimeEvents.Num());
+	check(EventIndex < RuntimeSchema->Events.Num());
 	check(Controller == GetOwner());
 
 	// Translate given input event and find out an event index for translated event
 	if (Controller)
 	{
-		FName OriginalEvent = RuntimeEvents[EventIndex].Name;
+		FName OriginalEvent = RuntimeSchema->Events[EventIndex].Name;
 		FName TranslatedEvent = Controller->TranslateInputEvent(OriginalEvent);
 		if (OriginalEvent != TranslatedEvent)
 		{
 			// Set the original event bit
-			CurrentRecord.TranslatedEvents |= (1LL << EventIndex);
+			CurrentRecord.TranslatedEvents.SetBit(EventIndex);
 
-			int32* FoundIndex = EventIndexMap.Find(TranslatedEvent);
+			int32* FoundIndex = RuntimeSchema->EventIndexMap.Find(TranslatedEvent);
 			if (FoundIndex == nullptr)
 			{
 				if (TranslatedEvent == NAME_None)
@@ -273,124 +487,353 @@ void UInputBufferComponent::RecordEvent(uint64 EventIndex, AInputBufferPlayerCon
 	}
 
 	// Set the event bit
-	CurrentRecord.Events |= (1LL << EventIndex);
+	CurrentRecord.Events.SetBit(EventIndex);
 }
 
-void UInputBufferComponent::ClearHistory()
+FString UInputBufferComponent::GetRecordingPath(const FString& FileName)
 {
-	InputHistory.Reset(MaxInputHistory);
+	return FPaths::IsRelative(FileName) ? FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("InputRecordings"), FileName) : FileName;
 }
 
-void UInputBufferComponent::InvalidateHistory()
+bool UInputBufferComponent::StartRecording(const FString& FileName)
 {
-	auto Record = InputHistory.GetData();
-	auto RecordEnd = Record + InputHistory.Num();
-	for (; Record != RecordEnd; Record++)
+	StopRecording();
+
+	const FString Path = GetRecordingPath(FileName);
+	RecordingArchive.Reset(IFileManager::Get().CreateFileWriter(*Path));
+	if (!RecordingArchive)
 	{
-		Record->bValid = false;
+		UE_LOG(InputBufferLog, Warning, TEXT("Cannot open '%s' for input recording."), *Path);
+		return false;
 	}
+
+	TArray<FName> EventNames;
+	EventNames.Reserve(RuntimeSchema->Events.Num());
+	for (const auto& Event : RuntimeSchema->Events)
+	{
+		EventNames.Add(Event.Name);
+	}
+
+	Recorder = MakeUnique<FInputRecordingWriter>(*RecordingArchive, EventNames);
+	return true;
 }
 
-bool UInputBufferComponent::ConvertEventsToFlags(const TArray<FName>& Events, uint64& Flags) const
+void UInputBufferComponent::StopRecording()
 {
-	bool bSucceeded = true;
-	for (int32 Idx = 0; Idx < Events.Num(); Idx++)
+	Recorder.Reset();
+	if (RecordingArchive)
 	{
-		const int32* Index = EventIndexMap.Find(Events[Idx]);
-		if (Index)
+		RecordingArchive->Close();
+		RecordingArchive.Reset();
+	}
+}
+
+bool UInputBufferComponent::StartReplay(const FString& FileName)
+{
+	StopReplay();
+
+	const FString Path = GetRecordingPath(FileName);
+	ReplayArchive.Reset(IFileManager::Get().CreateFileReader(*Path));
+	if (!ReplayArchive)
+	{
+		UE_LOG(InputBufferLog, Warning, TEXT("Cannot open '%s' for input replay."), *Path);
+		return false;
+	}
+
+	ReplayReader = MakeUnique<FInputRecordingReader>(*ReplayArchive);
+	if (!ReplayReader->IsValid())
+	{
+		UE_LOG(InputBufferLog, Warning, TEXT("'%s' is not a valid input recording."), *Path);
+		StopReplay();
+		return false;
+	}
+
+	// Map recorded events by name, so that recordings survive changes to event set-ups.
+	const TArray<FName>& EventNames = ReplayReader->GetEventNames();
+	bool bSameIndices = EventNames.Num() == RuntimeSchema->Events.Num();
+	ReplayEventMap.Init(INDEX_NONE, EventNames.Num());
+	for (int32 Idx = 0; Idx < EventNames.Num(); Idx++)
+	{
+		if (const int32* Index = RuntimeSchema->EventIndexMap.Find(EventNames[Idx]))
 		{
-			Flags |= (1LL << *Index); // Set the event bit
+			ReplayEventMap[Idx] = *Index;
 		}
 		else
 		{
-			bSucceeded = false; // Any unknown event means a failure.
+			UE_LOG(InputBufferLog, Warning, TEXT("Recorded input event '%s' is not registered and will be dropped."), *EventNames[Idx].ToString());
 		}
+		bSameIndices &= ReplayEventMap[Idx] == Idx;
+	}
+	if (bSameIndices)
+	{
+		ReplayEventMap.Reset();
 	}
 
-	return bSucceeded;
+	// Replays start from an empty input buffer so that they are deterministic.
+	ClearHistory();
+	ReplayStartTime = GetCurrentTime();
+	ReadReplayFrame();
+	return true;
+}
+
+void UInputBufferComponent::StopReplay()
+{
+	ReplayReader.Reset();
+	ReplayArchive.Reset();
+	ReplayEventMap.Reset();
+	bHasReplayFrame = false;
 }
 
-void UInputBufferComponent::ConvertFlagsToEvents(uint64 Flags, TArray<FName>& Events) const
+void UInputBufferComponent::ReadReplayFrame()
 {
-	// TODO: Reduce complexity
-	for (int Idx = 0; Idx < RuntimeEvents.Num() && Flags != 0; Idx++)
+	FInputEventFlags Events;
+	FInputEventFlags Translated;
+	bHasReplayFrame = ReplayReader->ReadFrame(Events, Translated, ReplayFrameTime);
+
+	if (ReplayEventMap.Num() == 0)
 	{
-		if (Flags & 0x1)
+		ReplayEvents = Events;
+		ReplayTranslatedEvents = Translated;
+		return;
+	}
+
+	ReplayEvents = FInputEventFlags();
+	ReplayTranslatedEvents = FInputEventFlags();
+
+	auto MapEvent = [this](FInputEventFlags& MappedEvents, int32 Bit)
+	{
+		if (ReplayEventMap.IsValidIndex(Bit) && ReplayEventMap[Bit] != INDEX_NONE)
+		{
+			MappedEvents.SetBit(ReplayEventMap[Bit]);
+		}
+	};
+	Events.ForEachSetBit([this, &MapEvent](int32 Bit) { MapEvent(ReplayEvents, Bit); });
+	Translated.ForEachSetBit([this, &MapEvent](int32 Bit) { MapEvent(ReplayTranslatedEvents, Bit); });
+}
+
+void UInputBufferComponent::ProcessReplay(float CurrTime, AInputBufferPlayerController* Controller)
+{
+	while (bHasReplayFrame)
+	{
+		const float FrameTime = (float)(ReplayStartTime + ReplayFrameTime);
+		if (FrameTime > CurrTime)
 		{
-			Events.Add(RuntimeEvents[Idx].Name);
+			break;
 		}
 
-		Flags >>= 1;
+		// Recorded events are already translated, so buffer them as they are.
+		BeginRecord(FrameTime);
+		CurrentRecord.Events = ReplayEvents;
+		CurrentRecord.TranslatedEvents = ReplayTranslatedEvents;
+		CommitRecord(Controller);
+
+		ReadReplayFrame();
+	}
+
+	if (!bHasReplayFrame)
+	{
+		StopReplay();
 	}
 }
 
-void UInputBufferComponent::GetCurrentEvents(TArray<FName>& Events) const
+int32 UInputBufferComponent::GetSnapshotSize() const
 {
-	ConvertFlagsToEvents(CurrentRecord.Events, Events);
+	return sizeof(CurrentRecord) + RuntimeSchema->NumKeyWords * sizeof(uint64) + sizeof(EventsDown) + 2 * RuntimeSchema->Events.Num() * sizeof(float)
+		+ InputHistory.GetSnapshotSize() + Recognizer.GetSnapshotSize();
 }
 
-const FInputBufferRecord* UInputBufferComponent::GetLastRecord(float TimeLimit, bool bSkipEmptyTrail) const
+void UInputBufferComponent::ReserveSnapshots(int32 NumFrames)
 {
-	if (bSkipEmptyTrail)
+	NumFrames = FMath::Max(NumFrames, 0);
+	SnapshotSize = GetSnapshotSize();
+	SnapshotFrames.Init(INDEX_NONE, NumFrames);
+	SnapshotData.SetNumUninitialized(SnapshotSize * NumFrames);
+}
+
+void UInputBufferComponent::InvalidateSnapshots()
+{
+	for (int32& Frame : SnapshotFrames)
 	{
-		return GetLastNonEmptyRecord(TimeLimit);
+		Frame = INDEX_NONE;
 	}
-	else
+}
+
+void UInputBufferComponent::SaveSnapshot(int32 Frame)
+{
+	if (SnapshotFrames.Num() == 0 || Frame < 0)
+	{
+		UE_LOG(InputBufferLog, Warning, TEXT("Cannot save snapshot of frame %d. Call ReserveSnapshots first."), Frame);
+		return;
+	}
+
+	if (GetSnapshotSize() != SnapshotSize)
+	{
+		// The capacity of the input buffer changed, so the ring has to be reallocated.
+		ReserveSnapshots(SnapshotFrames.Num());
+	}
+
+	const int32 Slot = Frame % SnapshotFrames.Num();
+	uint8* Data = SnapshotData.GetData() + Slot * SnapshotSize;
+
+	InputBufferSnapshot::Write(Data, &CurrentRecord, 1);
+	InputBufferSnapshot::Write(Data, CurrentKeyStates->GetData(), RuntimeSchema->NumKeyWords);
+	InputBufferSnapshot::Write(Data, &EventsDown, 1);
+	InputBufferSnapshot::Write(Data, EventPressTimes.GetData(), RuntimeSchema->Events.Num());
+	InputBufferSnapshot::Write(Data, EventReleaseTimes.GetData(), RuntimeSchema->Events.Num());
+	InputHistory.SaveSnapshot(Data);
+	Recognizer.SaveSnapshot(Data + InputHistory.GetSnapshotSize());
+
+	SnapshotFrames[Slot] = Frame;
+}
+
+bool UInputBufferComponent::RestoreSnapshot(int32 Frame)
+{
+	if (SnapshotFrames.Num() == 0 || Frame < 0 || GetSnapshotSize() != SnapshotSize)
+	{
+		return false;
+	}
+
+	const int32 Slot = Frame % SnapshotFrames.Num();
+	if (SnapshotFrames[Slot] != Frame)
 	{
-		return GetLastRecord(TimeLimit);
+		return false;
 	}
+
+	const uint8* Data = SnapshotData.GetData() + Slot * SnapshotSize;
+
+	InputBufferSnapshot::Read(Data, &CurrentRecord, 1);
+	InputBufferSnapshot::Read(Data, CurrentKeyStates->GetData(), RuntimeSchema->NumKeyWords);
+	InputBufferSnapshot::Read(Data, &EventsDown, 1);
+	InputBufferSnapshot::Read(Data, EventPressTimes.GetData(), RuntimeSchema->Events.Num());
+	InputBufferSnapshot::Read(Data, EventReleaseTimes.GetData(), RuntimeSchema->Events.Num());
+	InputHistory.RestoreSnapshot(Data);
+	Recognizer.RestoreSnapshot(Data + InputHistory.GetSnapshotSize());
+	PublishEventTimes(false);
+
+	return true;
+}
+
+void UInputBufferComponent::ClearHistory()
+{
+	InputHistory.Reset(MaxInputHistory);
+	Recognizer.ResetProgress();
 }
 
-const FInputBufferRecord* UInputBufferComponent::GetLastRecord(float TimeLimit) const
+void UInputBufferComponent::InvalidateHistory()
 {
-	float CurrentTime = GetCurrentTime();
+	InputHistory.InvalidateAll();
+
+	Recognizer.ResetProgress();
+}
 
-	for (auto It = InputHistory.CreateConstReverseIterator(); It; ++It)
+bool UInputBufferComponent::ConvertEventsToFlags(const TArray<FName>& Events, FInputEventFlags& Flags) const
+{
+	bool bSucceeded = true;
+	for (int32 Idx = 0; Idx < Events.Num(); Idx++)
 	{
-		const FInputBufferRecord& Record = *It;
-		if (Record.bValid && (CurrentTime - Record.EndTime <= TimeLimit || TimeLimit == 0.f))
+		const int32* Index = RuntimeSchema->EventIndexMap.Find(Events[Idx]);
+		if (Index)
 		{
-			return &Record;
+			Flags.SetBit(*Index); // Set the event bit
 		}
 		else
 		{
-			break;
+			bSucceeded = false; // Any unknown event means a failure.
 		}
 	}
 
-	return nullptr;
+	return bSucceeded;
+}
+
+void UInputBufferComponent::ConvertFlagsToEvents(const FInputEventFlags& Flags, TArray<FName>& Events) const
+{
+	Flags.ForEachSetBit([this, &Events](int32 Index)
+	{
+		Events.Add(RuntimeSchema->Events[Index].Name);
+	});
+}
+
+void UInputBufferComponent::GetCurrentEvents(TArray<FName>& Events) const
+{
+	ConvertFlagsToEvents(CurrentRecord.Events, Events);
+}
+
+float UInputBufferComponent::GetHeldDuration(FName Event) const
+{
+	const int32* Index = RuntimeSchema->EventIndexMap.Find(Event);
+	return Index && EventsDown.TestBit(*Index) ? GetCurrentTime() - EventPressTimes[*Index] : 0.f;
+}
+
+float UInputBufferComponent::GetTimeSincePressed(FName Event) const
+{
+	const int32* Index = RuntimeSchema->EventIndexMap.Find(Event);
+	return Index && EventPressTimes[*Index] != NeverTime ? GetCurrentTime() - EventPressTimes[*Index] : -1.f;
+}
+
+float UInputBufferComponent::GetTimeSinceReleased(FName Event) const
+{
+	const int32* Index = RuntimeSchema->EventIndexMap.Find(Event);
+	return Index && EventReleaseTimes[*Index] != NeverTime ? GetCurrentTime() - EventReleaseTimes[*Index] : -1.f;
+}
+
+float UInputBufferComponent::GetHeldDurationAnyThread(FName Event) const
+{
+	FScopeLock Lock(&PublishedEventTimesLock);
+	const int32* Index = PublishedEventTimes.EventIndexMap.Find(Event);
+	return Index && PublishedEventTimes.EventsDown.TestBit(*Index) ? PublishedEventTimes.Time - PublishedEventTimes.PressTimes[*Index] : 0.f;
+}
+
+float UInputBufferComponent::GetTimeSincePressedAnyThread(FName Event) const
+{
+	FScopeLock Lock(&PublishedEventTimesLock);
+	const int32* Index = PublishedEventTimes.EventIndexMap.Find(Event);
+	return Index && PublishedEventTimes.PressTimes[*Index] != NeverTime ? PublishedEventTimes.Time - PublishedEventTimes.PressTimes[*Index] : -1.f;
+}
+
+float UInputBufferComponent::GetTimeSinceReleasedAnyThread(FName Event) const
+{
+	FScopeLock Lock(&PublishedEventTimesLock);
+	const int32* Index = PublishedEventTimes.EventIndexMap.Find(Event);
+	return Index && PublishedEventTimes.ReleaseTimes[*Index] != NeverTime ? PublishedEventTimes.Time - PublishedEventTimes.ReleaseTimes[*Index] : -1.f;
 }
 
-const FInputBufferRecord* UInputBufferComponent::GetLastNonEmptyRecord(float TimeLimit) const
+void UInputBufferComponent::PublishEventTimes(bool bSchemaChanged)
 {
-	float CurrentTime = GetCurrentTime();
+	FScopeLock Lock(&PublishedEventTimesLock);
 
-	for (auto It = InputHistory.CreateConstReverseIterator(); It; ++It)
+	if (bSchemaChanged)
 	{
-		const FInputBufferRecord& Record = *It;
-		if (Record.bValid && (CurrentTime - Record.EndTime <= TimeLimit || TimeLimit == 0.f))
-		{
-			if (Record.Events != 0)
-			{
-				return &Record;
-			}
-		}
-		else
-		{
-			break;
-		}
+		PublishedEventTimes.EventIndexMap = RuntimeSchema->EventIndexMap;
+		PublishedEventTimes.PressTimes.SetNumUninitialized(EventPressTimes.Num());
+		PublishedEventTimes.ReleaseTimes.SetNumUninitialized(EventReleaseTimes.Num());
 	}
 
-	return nullptr;
+	// The sizes only change with the schema, so the copies do not allocate.
+	PublishedEventTimes.EventsDown = EventsDown;
+	FMemory::Memcpy(PublishedEventTimes.PressTimes.GetData(), EventPressTimes.GetData(), EventPressTimes.Num() * sizeof(float));
+	FMemory::Memcpy(PublishedEventTimes.ReleaseTimes.GetData(), EventReleaseTimes.GetData(), EventReleaseTimes.Num() * sizeof(float));
+	PublishedEventTimes.Time = CurrentRecord.StartTime;
+}
+
+int32 UInputBufferComponent::FindLastRecord(float TimeLimit, bool bSkipEmptyTrail) const
+{
+	// Only the trailing run of valid records within the time limit is searched.
+	const int32 FirstIndex = FMath::Max(InputHistory.FindFirstInTimeWindow(GetCurrentTime(), TimeLimit), InputHistory.FindFirstOfValidTrail());
+	if (FirstIndex >= InputHistory.Num())
+	{
+		return INDEX_NONE;
+	}
+
+	return bSkipEmptyTrail ? InputHistory.FindLastNonEmpty(FirstIndex) : InputHistory.Num() - 1;
 }
 
 float UInputBufferComponent::GetLastEvents(TArray<FName>& Events, float TimeLimit, bool bSkipEmptyTrail) const
 {
-	const FInputBufferRecord* Record = GetLastRecord(TimeLimit, bSkipEmptyTrail);
-	if (Record)
+	const int32 RecordIndex = FindLastRecord(TimeLimit, bSkipEmptyTrail);
+	if (RecordIndex != INDEX_NONE)
 	{
-		ConvertFlagsToEvents(Record->Events, Events);
-		return Record->EndTime;
+		ConvertFlagsToEvents(InputHistory.GetEvents(RecordIndex), Events);
+		return InputHistory.GetEndTime(RecordIndex);
 	}
 	else
 	{
@@ -400,58 +843,53 @@ float UInputBufferComponent::GetLastEvents(TArray<FName>& Events, float TimeLimi
 
 void UInputBufferComponent::GetHistoryRecords(TArray<FInputHistoryRecord>& Records, float TimeLimit, bool bIncludeInvalidRecords) const
 {
-	float CurrentTime = GetCurrentTime();
-
-	for (auto It = InputHistory.CreateConstReverseIterator(); It; ++It)
+	int32 FirstIndex = InputHistory.FindFirstInTimeWindow(GetCurrentTime(), TimeLimit);
+	if (!bIncludeInvalidRecords)
 	{
-		const auto& Record = *It;
-		if ((Record.bValid || bIncludeInvalidRecords) && (CurrentTime - Record.EndTime <= TimeLimit || TimeLimit == 0.f))
-		{
-			FInputHistoryRecord Copy(Record.StartTime, Record.EndTime, Record.bValid);
-			ConvertFlagsToEvents(Record.Events, Copy.Events);
-			ConvertFlagsToEvents(Record.TranslatedEvents, Copy.TranslatedEvents);
-
-			Records.Add(Copy);
-		}
-		else
-		{
-			break;
-		}
+		FirstIndex = FMath::Max(FirstIndex, InputHistory.FindFirstOfValidTrail());
 	}
 
-	Algo::Reverse(Records);
+	Records.Reserve(Records.Num() + InputHistory.Num() - FirstIndex);
+	for (int32 Idx = FirstIndex; Idx < InputHistory.Num(); Idx++)
+	{
+		FInputHistoryRecord& Copy = Records.Emplace_GetRef(InputHistory.GetStartTime(Idx), InputHistory.GetEndTime(Idx), InputHistory.IsValid(Idx));
+		ConvertFlagsToEvents(InputHistory.GetEvents(Idx), Copy.Events);
+		ConvertFlagsToEvents(InputHistory.GetTranslatedEvents(Idx), Copy.TranslatedEvents);
+	}
 }
 
 bool UInputBufferComponent::SetHistoryRecords(const TArray<FInputHistoryRecord>& Records)
 {
 	bool AllSucceeded = true;
-	InputHistory.Reset(Records.Num());
+	InputHistory.Reset(FMath::Max(MaxInputHistory, Records.Num()));
 
 	for (const auto& Record : Records)
 	{
-		uint64 Flags = 0;
-		uint64 TranslatedFlags = 0;
+		FInputEventFlags Flags;
+		FInputEventFlags TranslatedFlags;
 		AllSucceeded = AllSucceeded && ConvertEventsToFlags(Record.Events, Flags);
 		AllSucceeded = AllSucceeded && ConvertEventsToFlags(Record.TranslatedEvents, TranslatedFlags);
 
-		InputHistory.Add(FInputBufferRecord(Record.StartTime, Record.EndTime, Flags, TranslatedFlags, Record.bValid));
+		InputHistory.Push(FInputBufferRecord(Record.StartTime, Record.EndTime, Flags, TranslatedFlags, Record.bValid));
 	}
 
+	ReplayHistoryToRecognizer();
+
 	return AllSucceeded;
 }
 
 bool UInputBufferComponent::MatchEvents(const TArray<FName>& EventsToMatch, const TArray<FName>& EventsToIgnore, float TimeLimit, bool bSkipEmptyTrail) const
 {
-	const FInputBufferRecord* Record = GetLastRecord(TimeLimit, bSkipEmptyTrail);
-	if (Record)
+	const int32 RecordIndex = FindLastRecord(TimeLimit, bSkipEmptyTrail);
+	if (RecordIndex != INDEX_NONE)
 	{
-		uint64 MatchingFlags = 0; // The bit flags of events to match.
+		FInputEventFlags MatchingFlags; // The bit flags of events to match.
 		if (ConvertEventsToFlags(EventsToMatch, MatchingFlags))
 		{
-			uint64 IgnoringFlags = 0; // The bit flags of events to ignore.
+			FInputEventFlags IgnoringFlags; // The bit flags of events to ignore.
 			ConvertEventsToFlags(EventsToIgnore, IgnoringFlags);
 
-			if (CompareEventFlags(Record->Events, MatchingFlags, IgnoringFlags))
+			if (CompareEventFlags(InputHistory.GetEvents(RecordIndex), MatchingFlags, IgnoringFlags))
 			{
 				return true;
 			}
@@ -468,216 +906,307 @@ bool UInputBufferComponent::MatchCommand(class UInputCommand* Command) const
 		return false; // because of nothing to match
 	}
 
-	uint64 OuterIgnoreFlags = 0;
-	ConvertEventsToFlags(Command->EventsToIgnore, OuterIgnoreFlags);
+	return MatchCompiledCommand(GetCompiledCommand(Command), GetCurrentTime());
+}
+
+bool UInputBufferComponent::ConsumeCommand(UInputCommand* Command)
+{
+	if (Command == nullptr || InputHistory.Num() == 0)
+	{
+		return false; // because of nothing to match
+	}
 
 	const float CurrTime = GetCurrentTime();
 
-	for (FInputCommandSequence& Sequence : Command->Sequences)
+	int32 FirstUsed, LastUsed;
+	if (!MatchCompiledCommand(GetCompiledCommand(Command), CurrTime, &FirstUsed, &LastUsed))
+	{
+		return false;
+	}
+
+	ConsumeRecords(FirstUsed, LastUsed);
+	UpdateRecognizedCommands(CurrTime, false);
+
+	return true;
+}
+
+void UInputBufferComponent::ConsumeRecords(int32 FirstIndex, int32 LastIndex)
+{
+	if (LastIndex == INDEX_NONE)
 	{
-		if (Sequence.bEnabled)
+		return; // because no record is used
+	}
+
+	InputHistory.Invalidate(FirstIndex, LastIndex);
+
+	// Records before the consumed ones can no longer be reached either, since matching stops at invalid records.
+	const int32 NumRemaining = InputHistory.Num() - 1 - LastIndex;
+	Recognizer.DiscardOlderRecords(NumRemaining, NumRemaining > 0 ? InputHistory.GetRecord(LastIndex + 1) : FInputBufferRecord());
+}
+
+void UInputBufferComponent::WatchCommand(UInputCommand* Command)
+{
+	if (Command && !WatchedCommands.Contains(Command))
+	{
+		WatchedCommands.Add(Command);
+		RebuildRecognizer();
+	}
+}
+
+void UInputBufferComponent::UnwatchCommand(UInputCommand* Command)
+{
+	if (WatchedCommands.Remove(Command) > 0)
+	{
+		RebuildRecognizer();
+	}
+}
+
+bool UInputBufferComponent::IsCommandRecognized(UInputCommand* Command) const
+{
+	const int32* CommandIdx = WatchedCommandIndexMap.Find(Command);
+	return CommandIdx && Recognizer.IsMatched(*CommandIdx);
+}
+
+void UInputBufferComponent::RebuildRecognizer()
+{
+	TArray<FCompiledInputCommand> Commands;
+	Commands.Reserve(WatchedCommands.Num());
+	WatchedCommandIndexMap.Reset();
+
+	for (int32 Idx = 0; Idx < WatchedCommands.Num(); Idx++)
+	{
+		UInputCommand* Command = WatchedCommands[Idx];
+		if (Command)
 		{
-			bool bRepeating = false; // Are we trying to repeat the current entry?
-			float CurrEntryStartTime = 0; // The start time of the oldest matching record for the current entry. Used to check durations of entries.
-			float CurrEntryEndTime = 0; // The end time of the latest matching record for the current entry. Used to check durations of entries.
-			float PrevEntryStartTime = 0; // The start time of the oldest matching record for the previous entry. Used to check durations and interval of entries.
-			float PrevEntryEndTime = 0; // The end time of the latest matching record for the previous entry. Used to check durations of entries.
-			int32 EntryIdx = Sequence.Entries.Num() - 1; // The index of the command entry to match in the current iteration.
-			auto It = InputHistory.CreateConstReverseIterator(); // Input history iterator.
-
-			while (EntryIdx >= 0)
+			Commands.Add(GetCompiledCommand(Command));
+			WatchedCommandIndexMap.Add(Command, Idx);
+		}
+		else
+		{
+			Commands.AddDefaulted(); // Keep indices the same as WatchedCommands.
+		}
+	}
+
+	Recognizer.SetCommands(MoveTemp(Commands));
+	ReplayHistoryToRecognizer();
+
+	// Saved progress refers to the old commands.
+	InvalidateSnapshots();
+}
+
+void UInputBufferComponent::ReplayHistoryToRecognizer()
+{
+	Recognizer.ResetProgress();
+
+	for (int32 Idx = 0; Idx < InputHistory.Num(); Idx++)
+	{
+		Recognizer.PushRecord(InputHistory.GetRecord(Idx), Idx + 1, InputHistory.GetRecord(0));
+	}
+
+	UpdateRecognizedCommands(GetCurrentTime(), false);
+}
+
+void UInputBufferComponent::UpdateRecognizedCommands(float CurrTime, bool bNotify)
+{
+	if (Recognizer.Evaluate(CurrTime) && bNotify)
+	{
+		bool bConsumed = false;
+		for (int32 Idx = 0; Idx < Recognizer.NumCommands(); Idx++)
+		{
+			if (Recognizer.IsNewlyMatched(Idx))
 			{
-				const FInputCommandEntry& Entry = Sequence.Entries[EntryIdx];
-				//if (Entry.EventsToMatch.Num() == 0)
-				//{
-				//	break; // because of nothing to match
-				//}
-
-				const FInputBufferRecord& Record = *It;
-				if (!Record.bValid)
+				const FCompiledInputCommand& Command = GetCompiledCommand(WatchedCommands[Idx]);
+				if (Command.bConsumeInput || bConsumed)
 				{
-					if (bRepeating && EntryIdx == 0)
+					// Find out the records used by the match. The match may be gone if a prior command has consumed its input.
+					int32 FirstUsed, LastUsed;
+					if (!MatchCompiledCommand(Command, CurrTime, &FirstUsed, &LastUsed))
 					{
-						if (!Entry.CheckDuration(CurrEntryEndTime - CurrEntryStartTime))
-						{
-							break;
-						}
-						// Even if we failed to repeat the first entry, command recognition still succeeds since we have found matching records for all entries.
-						return true;
+						continue;
 					}
-					else
+
+					if (Command.bConsumeInput)
 					{
-						break; // Need not check the previous records since they should be invalid too.
+						ConsumeRecords(FirstUsed, LastUsed);
+						bConsumed = true;
 					}
 				}
 
-				if (CurrTime - Record.EndTime > Command->TimeLimit && Command->TimeLimit != 0.f && !bRepeating)
-				{
-					break;
-				}
+				OnCommandRecognized.Broadcast(WatchedCommands[Idx]);
+			}
+		}
 
-				//TArray<FName> RecordedEvents;
-				//ConvertFlagsToEvents(Record.Events, RecordedEvents);
+		if (bConsumed)
+		{
+			Recognizer.Evaluate(CurrTime); // Commands whose input has been consumed are no longer recognized.
+		}
+	}
+}
 
-				bool bMatched = false; // Whether the current record matches the current entry?
-				bool bNextEntry = false; // Should we advance to the next entry in the next iteraion?
-				bool bNextRecord = false; // Should we advance to the next record in the next iteraion?
-				uint64 MatchingFlags = 0; // The bit flags of events to match.
-				uint64 IgnoringFlags = 0; // The bit flags of events to ignore.
-				if (ConvertEventsToFlags(Entry.EventsToMatch, MatchingFlags))
-				{
-					// For events to match, unknown events means mismatch. But for events to ignore, unknown events are omitted.
-					ConvertEventsToFlags(Entry.EventsToIgnore, IgnoringFlags);
+const FCompiledInputCommand& UInputBufferComponent::GetCompiledCommand(const UInputCommand* Command) const
+{
+	check(Command);
 
-					if (Entry.bIgnoreOthers)
-					{
-						bMatched = HasEventFlags(Record.Events, MatchingFlags);
-					}
-					else
-					{
-						IgnoringFlags |= OuterIgnoreFlags;
-						bMatched = CompareEventFlags(Record.Events, MatchingFlags, IgnoringFlags);
-					}
-				}
-				else
-				{
-					break; // Fails since we cannot find flags for unknown events.
-				}
+	// Commands of a shared schema are compiled once for all the input buffers using it.
+	if (const FCompiledInputCommand* Shared = RuntimeSchema->Commands.Find(Command))
+	{
+		return *Shared;
+	}
 
-				if (bMatched)
-				{
-					if (CurrEntryEndTime == 0)
-					{
-						// Check limits of the duration of the previous entry.
-						if (PrevEntryEndTime != 0.f)
-						{
-							const FInputCommandEntry& PrevEntry = Sequence.Entries[EntryIdx + 1];
-							if (!PrevEntry.CheckDuration(PrevEntryEndTime - PrevEntryStartTime))
-							{
-								break;
-							}
-						}
-
-						// Check limits of the internal between the current entry and previous entry.
-						if (PrevEntryStartTime != 0.f && !Entry.CheckInterval(PrevEntryStartTime - Record.EndTime))
-						{
-							break;
-						}
-
-						CurrEntryEndTime = Record.EndTime;
-					}
-					CurrEntryStartTime = Record.StartTime;
+	FCompiledInputCommand* Compiled = CompiledCommands.Find(Command);
+	if (Compiled == nullptr)
+	{
+		Compiled = &CompiledCommands.Add(Command);
+		Compiled->Compile(*Command, RuntimeSchema->EventIndexMap);
+	}
 
-					bRepeating = true;
-					bNextRecord = true;
-				}
-				else if (bRepeating)
-				{
-					if (EntryIdx == 0)
-					{
-						if (!Entry.CheckDuration(CurrEntryEndTime - CurrEntryStartTime))
-						{
-							break;
-						}
-						// Even if we failed to repeat the first entry, command recognition still succeeds since we have found matching records for all entries.
-						return true;
-					}
-					else
-					{
-						bRepeating = false;
-						bNextEntry = true;
-					}
-				}
-				else if (Record.Events == 0)
-				{
-					// Skip the current record when there is no input.
-					bRepeating = false;
-					bNextRecord = true;
-				}
-				else if (Entry.bIgnoreOthers || ((Record.Events | IgnoringFlags) == IgnoringFlags))
-				{
-					// If the input events do not match but are all neglectable, we can try the next record with the current entry.
-					bRepeating = false;
-					bNextRecord = true;
-				}
-				else
-				{
-					break; // Fails due to mismatch.
-				}
+	return *Compiled;
+}
 
-				if (bNextRecord)
-				{
-					++It;
-					if (!It) // If there is no remaining history.
-					{
-						if (EntryIdx == 0 && bMatched)
-						{
-							if (!Entry.CheckDuration(CurrEntryEndTime - CurrEntryStartTime))
-							{
-								break;
-							}
-
-							return true; // Succeeds since we have checked all the entries and didn't fail.
-						}
-						else
-						{
-							break; // Fails because of mismatch or no remaining history to match the next entry.
-						}
-					}
-				}
+bool UInputBufferComponent::MatchCompiledCommand(const FCompiledInputCommand& Command, float CurrTime, int32* OutFirstUsed, int32* OutLastUsed) const
+{
+	if (InputHistory.Num() == 0)
+	{
+		return false; // because of nothing to match
+	}
 
-				if (bNextEntry)
-				{
-					if (CurrEntryEndTime != 0)
-					{
-						PrevEntryStartTime = CurrEntryStartTime;
-						PrevEntryEndTime = CurrEntryEndTime;
-						CurrEntryStartTime = 0.f;
-						CurrEntryEndTime = 0.f;
-					}
+	for (const FCompiledInputCommandSequence& Sequence : Command.Sequences)
+	{
+		const FCompiledInputCommandEntry* Entries = Command.Entries.GetData() + Sequence.FirstEntry;
+		FInputCommandMatchState State(Sequence.NumEntries);
 
-					EntryIdx--;
-				}
+		int32 FirstUsed = INDEX_NONE;
+		int32 LastUsed = INDEX_NONE;
+
+		EInputCommandMatchResult Result = EInputCommandMatchResult::Pending;
+		for (int32 Idx = InputHistory.Num() - 1; Idx >= 0 && Result == EInputCommandMatchResult::Pending; Idx--)
+		{
+			Result = State.Step(Entries, Command.TimeLimit, InputHistory.GetRecord(Idx), CurrTime);
+
+			// A pending state is repeating an entry only if the record matched it.
+			if (Result == EInputCommandMatchResult::Pending && State.bRepeating)
+			{
+				FirstUsed = Idx;
+				LastUsed = (LastUsed == INDEX_NONE) ? Idx : LastUsed;
 			}
+		}
+
+		if (Result == EInputCommandMatchResult::Pending)
+		{
+			Result = State.Finish(Entries); // because there is no remaining history
+		}
 
-			if (EntryIdx == -1)
+		if (Result == EInputCommandMatchResult::Matched)
+		{
+			if (OutFirstUsed)
+			{
+				*OutFirstUsed = FirstUsed;
+			}
+			if (OutLastUsed)
 			{
-				return true; // Succeeds since we have checked all the entries and didn't fail.
+				*OutLastUsed = LastUsed;
 			}
+			return true;
 		}
 	}
 
 	return false;
 }
 
+bool UInputBufferComponent::MatchCommands(const TArray<UInputCommand*>& Commands, TArray<UInputCommand*>& OutMatched) const
+{
+	TArray<EInputCommandMatchResult, TInlineAllocator<64>> Results;
+	MatchCommandSet(Commands, false, Results);
+
+	bool bAnyMatched = false;
+	for (int32 Idx = 0; Idx < Results.Num(); Idx++)
+	{
+		if (Results[Idx] == EInputCommandMatchResult::Matched)
+		{
+			OutMatched.Add(Commands[Idx]);
+			bAnyMatched = true;
+		}
+	}
+
+	return bAnyMatched;
+}
+
+UInputCommand* UInputBufferComponent::MatchFirstCommand(const TArray<UInputCommand*>& Commands) const
+{
+	TArray<EInputCommandMatchResult, TInlineAllocator<64>> Results;
+	int32 FirstMatched = MatchCommandSet(Commands, true, Results);
+
+	return FirstMatched != INDEX_NONE ? Commands[FirstMatched] : nullptr;
+}
+
+int32 UInputBufferComponent::MatchCommandSet(const TArray<UInputCommand*>& Commands, bool bFirstOnly, TArray<EInputCommandMatchResult, TInlineAllocator<64>>& Results) const
+{
+	Results.Init(EInputCommandMatchResult::Failed, Commands.Num());
+
+	if (InputHistory.Num() == 0)
+	{
+		return INDEX_NONE; // because of nothing to match
+	}
+
+	// Merge sequences of all the commands into a single automaton.
+	FInputCommandSetMatcher Matcher;
+	for (const UInputCommand* Command : Commands)
+	{
+		Matcher.AddCommand(Command ? &GetCompiledCommand(Command) : nullptr);
+	}
+
+	const float CurrTime = GetCurrentTime();
+
+	// Walk the history once, feeding each record to the automaton.
+	Matcher.Begin();
+	for (int32 RecordIdx = InputHistory.Num() - 1; RecordIdx >= 0; RecordIdx--)
+	{
+		if (!Matcher.Step(InputHistory.GetRecord(RecordIdx), CurrTime))
+		{
+			break;
+		}
+
+		if (bFirstOnly)
+		{
+			const int32 FirstMatched = Matcher.FindFirstMatched();
+			if (FirstMatched != INDEX_NONE)
+			{
+				Results = Matcher.GetResults();
+				return FirstMatched;
+			}
+		}
+	}
+
+	// There is no remaining history for commands still undecided.
+	Matcher.Finish();
+
+	Results = Matcher.GetResults();
+	return Matcher.FindFirstMatched();
+}
+
 float UInputBufferComponent::GetCurrentTime() const
 {
 	UWorld* World = GetWorld();
 	return World ? World->GetRealTimeSeconds() : 0.f;
 }
 
-FString UInputBufferComponent::EventFlagsToString(uint64 Events, const FString& Separator) const
+FString UInputBufferComponent::EventFlagsToString(const FInputEventFlags& Events, const FString& Separator) const
 {
 	FString Result;
 	bool bFirst = true;
-	for (int Idx = 0; Idx < RuntimeEvents.Num(); Idx++)
+	Events.ForEachSetBit([this, &Result, &Separator, &bFirst](int32 Index)
 	{
-		if (Events & 0x1)
+		if (bFirst)
 		{
-			if (bFirst)
-			{
-				bFirst = false;
-			}
-			else
-			{
-				Result += Separator;
-			}
-
-			Result += RuntimeEvents[Idx].Name.ToString();
+			bFirst = false;
+		}
+		else
+		{
+			Result += Separator;
 		}
 
-		Events >>= 1;
-	}
+		Result += RuntimeSchema->Events[Index].Name.ToString();
+	});
 
 	return Result;
 }
@@ -695,34 +1224,17 @@ FString UInputBufferComponent::Print(int32 MaxRecords, bool bIncludeInvalidRecor
 		MaxRecords = FMath::Clamp(MaxRecords, 0, InputHistory.Num());
 	}
 
-	if (bReverseChronological)
+	const int32 StartIndex = InputHistory.Num() - MaxRecords;
+	for (int32 Count = 0; Count < MaxRecords; Count++)
 	{
-		int32 Count = 0;
-		for (auto It = InputHistory.CreateConstReverseIterator(); It && Count < MaxRecords; ++It, ++Count)
+		const int32 Idx = bReverseChronological ? InputHistory.Num() - 1 - Count : StartIndex + Count;
+		if (InputHistory.IsValid(Idx))
 		{
-			if (It->bValid)
-			{
-				Result += FString::Printf(TEXT("[%s] "), *EventFlagsToString(It->Events));
-			}
-			else if (bIncludeInvalidRecords)
-			{
-				Result += FString::Printf(TEXT("(%s) "), *EventFlagsToString(It->Events));
-			}
+			Result += FString::Printf(TEXT("[%s] "), *EventFlagsToString(InputHistory.GetEvents(Idx)));
 		}
-	}
-	else
-	{
-		int32 StartIndex = InputHistory.Num() - MaxRecords;
-		for (auto It = InputHistory.CreateConstIterator(StartIndex); It; ++It)
+		else if (bIncludeInvalidRecords)
 		{
-			if (It->bValid)
-			{
-				Result += FString::Printf(TEXT("[%s] "), *EventFlagsToString(It->Events));
-			}
-			else if (bIncludeInvalidRecords)
-			{
-				Result += FString::Printf(TEXT("(%s) "), *EventFlagsToString(It->Events));
-			}
+			Result += FString::Printf(TEXT("(%s) "), *EventFlagsToString(InputHistory.GetEvents(Idx)));
 		}
 	}
 
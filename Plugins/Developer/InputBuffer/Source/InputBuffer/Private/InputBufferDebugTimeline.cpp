@@ -0,0 +1,114 @@
+// Copyright 2018 Isaac Hsu.
+
+#include "InputBufferDebugTimeline.h"
+
+#include "CanvasItem.h"
+#include "Engine/Canvas.h"
+#include "Engine/Engine.h"
+
+#include "InputBufferComponent.h"
+
+FInputBufferDebugTimeline::FInputBufferDebugTimeline()
+	: Duration(2.f)
+	, Width(400.f)
+	, CachedSchema(nullptr)
+	, LabelWidth(0.f)
+	, LaneHeight(0.f)
+{
+}
+
+void FInputBufferDebugTimeline::CacheLabels(UCanvas* Canvas, const FCompiledInputBufferSchema& Schema)
+{
+	CachedSchema = &Schema;
+	Labels.Reset(Schema.EventNameStrings.Num());
+	LabelWidth = 0.f;
+	LaneHeight = 0.f;
+
+	const UFont* Font = GEngine->GetTinyFont();
+	for (const FString& Name : Schema.EventNameStrings)
+	{
+		Labels.Add(FText::FromString(Name));
+
+		float XL, YL;
+		Canvas->TextSize(Font, Name, XL, YL);
+		LabelWidth = FMath::Max(LabelWidth, XL);
+		LaneHeight = FMath::Max(LaneHeight, YL);
+	}
+
+	LabelWidth += 4.f;
+}
+
+float FInputBufferDebugTimeline::Draw(UCanvas* Canvas, const UInputBufferComponent& InputBuffer, float X, float Y)
+{
+	const FCompiledInputBufferSchema& Schema = InputBuffer.GetRuntimeSchema();
+	if (CachedSchema != &Schema || Labels.Num() != Schema.EventNameStrings.Num())
+	{
+		CacheLabels(Canvas, Schema);
+	}
+
+	const int32 NumLanes = Labels.Num();
+	const float Height = NumLanes * LaneHeight;
+	if (NumLanes == 0 || Duration <= 0.f)
+	{
+		return 0.f;
+	}
+
+	const UFont* Font = GEngine->GetTinyFont();
+	const float LanesX = X + LabelWidth;
+
+	FCanvasTileItem Background(FVector2D(LanesX, Y), FVector2D(Width, Height), FLinearColor(0.f, 0.f, 0.f, 0.5f));
+	Background.BlendMode = SE_BLEND_Translucent;
+	Canvas->DrawItem(Background);
+
+	FCanvasTextItem Label(FVector2D::ZeroVector, FText::GetEmpty(), Font, FLinearColor::White);
+	for (int32 Lane = 0; Lane < NumLanes; Lane++)
+	{
+		Label.Position = FVector2D(X, Y + Lane * LaneHeight);
+		Label.Text = Labels[Lane];
+		Canvas->DrawItem(Label);
+	}
+
+	const FInputHistory& History = InputBuffer.GetInputHistory();
+	if (History.Num() == 0)
+	{
+		return Height;
+	}
+
+	// Records are drawn from the latest one back, until they fall out of the time span.
+	const float EndTime = History.GetEndTime(History.Num() - 1);
+	const float StartTime = EndTime - Duration;
+	const float PixelsPerSecond = Width / Duration;
+	const float LaneSize = LaneHeight;
+
+	FCanvasTileItem Bar(FVector2D::ZeroVector, FVector2D::ZeroVector, FLinearColor::White);
+	Bar.BlendMode = SE_BLEND_Translucent;
+	for (int32 Idx = History.Num() - 1; Idx >= 0 && History.GetEndTime(Idx) >= StartTime; Idx--)
+	{
+		const float BarStart = LanesX + (FMath::Max(History.GetStartTime(Idx), StartTime) - StartTime) * PixelsPerSecond;
+		const float BarEnd = LanesX + (History.GetEndTime(Idx) - StartTime) * PixelsPerSecond;
+
+		// A record lasts at least until the next one starts.
+		const float NextStart = Idx + 1 < History.Num() ? LanesX + (History.GetStartTime(Idx + 1) - StartTime) * PixelsPerSecond : BarEnd;
+		const float BarWidth = FMath::Max(FMath::Max(BarEnd, NextStart) - BarStart, 1.f);
+
+		// Invalidated records are dimmed, and translated events are drawn over raw ones.
+		const float Alpha = History.IsValid(Idx) ? 1.f : 0.3f;
+		Bar.Size = FVector2D(BarWidth, LaneSize * 0.5f);
+
+		Bar.SetColor(FLinearColor(0.2f, 0.6f, 1.f, Alpha));
+		History.GetEvents(Idx).ForEachSetBit([Canvas, &Bar, BarStart, Y, LaneSize](int32 EventIdx)
+		{
+			Bar.Position = FVector2D(BarStart, Y + EventIdx * LaneSize);
+			Canvas->DrawItem(Bar);
+		});
+
+		Bar.SetColor(FLinearColor(1.f, 0.7f, 0.1f, Alpha));
+		History.GetTranslatedEvents(Idx).ForEachSetBit([Canvas, &Bar, BarStart, Y, LaneSize](int32 EventIdx)
+		{
+			Bar.Position = FVector2D(BarStart, Y + (EventIdx + 0.5f) * LaneSize);
+			Canvas->DrawItem(Bar);
+		});
+	}
+
+	return Height;
+}
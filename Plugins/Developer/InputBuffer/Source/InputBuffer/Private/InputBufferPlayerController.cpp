@@ -35,6 +35,17 @@ void AInputBufferPlayerController::PostProcessInput(const float DeltaTime, const
 	}
 }
 
+bool AInputBufferPlayerController::InputKey(FKey Key, EInputEvent EventType, float AmountDepressed, bool bGamepad)
+{
+	// Capture the key event before it is consumed, so that its arrival time is known.
+	if (InputBuffer)
+	{
+		InputBuffer->OnInputKey(Key, EventType);
+	}
+
+	return Super::InputKey(Key, EventType, AmountDepressed, bGamepad);
+}
+
 void AInputBufferPlayerController::DisplayDebug(class UCanvas* Canvas, const FDebugDisplayInfo& DebugDisplay, float& YL, float& YPos)
 {
 	Super::DisplayDebug(Canvas, DebugDisplay, YL, YPos);
@@ -42,8 +53,13 @@ void AInputBufferPlayerController::DisplayDebug(class UCanvas* Canvas, const FDe
 	static FName NAME_InputBuffer = FName(TEXT("InputBuffer"));
 	if (DebugDisplay.IsDisplayOn(NAME_InputBuffer) && InputBuffer)
 	{
+		static const FString Header(TEXT("InputBuffer:"));
+
 		FDisplayDebugManager& DisplayDebugManager = Canvas->DisplayDebugManager;
-		DisplayDebugManager.DrawString(FString::Printf(TEXT("InputBuffer: %s"), *InputBuffer->Print(MAX_INPUT_HISTORY_TO_DEBUG_DISPLAY, true)));
+		DisplayDebugManager.DrawString(Header);
+
+		const float Height = DebugTimeline.Draw(Canvas, *InputBuffer, DisplayDebugManager.GetXPos(), DisplayDebugManager.GetYPos());
+		DisplayDebugManager.ShiftYDrawPosition(Height);
 	}
 }
 
@@ -55,3 +71,14 @@ FName AInputBufferPlayerController::TranslateInputEvent_Implementation(FName Eve
 {
 	return Event;
 }
+
+void AInputBufferPlayerController::RefreshEventTranslations()
+{
+	if (InputBuffer)
+	{
+		InputBuffer->UpdateEventTranslations([this](FName Event)
+		{
+			return TranslateInputEvent(Event);
+		});
+	}
+}
@@ -0,0 +1,266 @@
+// Copyright 2018 Isaac Hsu.
+
+#include "InputBufferSchema.h"
+
+#include "InputBuffer.h"
+#include "InputCommand.h"
+
+/* Suffixes of direction event names, in the order of directions. */
+static const TCHAR* StickDirectionNames[FCompiledInputStick::NUM_DIRECTIONS] =
+{
+	TEXT("Right"), TEXT("UpRight"), TEXT("Up"), TEXT("UpLeft"), TEXT("Left"), TEXT("DownLeft"), TEXT("Down"), TEXT("DownRight"),
+};
+
+//////////////////////////////////////////////////////////////////////////
+// FCompiledInputStick
+
+int32 FCompiledInputStick::Quantize(float X, float Y, int32 Direction) const
+{
+	const float MinSize = Direction == INDEX_NONE ? DeadZone : ReleaseDeadZone;
+	if (X * X + Y * Y <= MinSize * MinSize)
+	{
+		return INDEX_NONE;
+	}
+
+	const float Angle = FMath::RadiansToDegrees(FMath::Atan2(Y, X));
+	const float SectorAngle = 360.f / NUM_DIRECTIONS;
+
+	// Keep the current direction until the stick passes the border of its sector by AngleHysteresis.
+	if (Direction != INDEX_NONE && FMath::Abs(FMath::UnwindDegrees(Angle - Direction * SectorAngle)) <= SectorAngle * 0.5f + AngleHysteresis)
+	{
+		return Direction;
+	}
+
+	return FMath::RoundToInt(Angle / SectorAngle) & (NUM_DIRECTIONS - 1);
+}
+
+//////////////////////////////////////////////////////////////////////////
+// FCompiledInputBufferSchema
+
+TSharedRef<FCompiledInputBufferSchema> FCompiledInputBufferSchema::Compile(const TArray<FBufferedInputEventSetup>& EventSetups, const TArray<FBufferedInputStickSetup>& StickSetups,
+	const TArray<FName>& TranslatedEvents, const TArray<FBufferedInputEventKeyMapping>& KeyMappings, const TArray<UInputCommand*>& Commands)
+{
+	TSharedRef<FCompiledInputBufferSchema> Schema = MakeShared<FCompiledInputBufferSchema>();
+	TArray<FBufferedInputEventSetup>& RuntimeEvents = Schema->Events;
+	TMap<FName, int32>& EventIndexMap = Schema->EventIndexMap;
+	TMap<FKey, int32>& KeyIndexMap = Schema->KeyIndexMap;
+	TArray<FKey>& RuntimeKeys = Schema->Keys;
+
+	RuntimeEvents.Reserve(EventSetups.Num() + StickSetups.Num() * FCompiledInputStick::NUM_DIRECTIONS + TranslatedEvents.Num());
+
+	TMap<FName, int32> KeyMappingIndexMap;
+	for (int Idx = 0; Idx < KeyMappings.Num(); Idx++)
+	{
+		auto& Mapping = KeyMappings[Idx];
+		if (Mapping.Name != NAME_None && Mapping.Keys.Num() > 0 && KeyMappingIndexMap.Find(Mapping.Name) == nullptr)
+		{
+			KeyMappingIndexMap.Add(Mapping.Name, Idx);
+		}
+	}
+
+	for (const auto& Setup : EventSetups)
+	{
+		if (Setup.bEnabled && Setup.Name != NAME_None && EventIndexMap.Find(Setup.Name) == nullptr)
+		{
+			if (RuntimeEvents.Num() >= FInputBufferRecord::MAX_EVENTS)
+			{
+				UE_LOG(InputBufferLog, Warning, TEXT("Cannot register input events more than %d."), FInputBufferRecord::MAX_EVENTS);
+				break;
+			}
+
+			// The use of a set makes sure there will be no duplicate keys.
+			TSet<FKey> KeySet;
+
+			for (const FKey& Key : Setup.Keys)
+			{
+				if (Key.IsValid())
+				{
+					KeySet.Add(Key);
+				}
+			}
+
+			if (Setup.KeyMappingName != NAME_None)
+			{
+				int32* Index = KeyMappingIndexMap.Find(Setup.KeyMappingName);
+				if (Index)
+				{
+					for (const FKey& Key : KeyMappings[*Index].Keys)
+					{
+						if (Key.IsValid())
+						{
+							KeySet.Add(Key);
+						}
+					}
+				}
+			}
+
+			if (KeySet.Num() > 0)
+			{
+				for (FKey& Key : KeySet)
+				{
+					if (KeyIndexMap.Find(Key) == nullptr)
+					{
+						KeyIndexMap.Add(Key, RuntimeKeys.Add(Key));
+					}
+				}
+
+				int32 Index = RuntimeEvents.Add(Setup);
+				EventIndexMap.Add(Setup.Name, Index);
+				RuntimeEvents[Index].Keys = KeySet.Array();
+			}
+			else
+			{
+				UE_LOG(InputBufferLog, Warning, TEXT("Input event '%s' does not have any valid key mappings."), *Setup.Name.ToString());
+			}
+		}
+	}
+
+	for (const auto& Setup : StickSetups)
+	{
+		if (Setup.bEnabled && Setup.Name != NAME_None)
+		{
+			if (RuntimeEvents.Num() + FCompiledInputStick::NUM_DIRECTIONS > FInputBufferRecord::MAX_EVENTS)
+			{
+				UE_LOG(InputBufferLog, Warning, TEXT("Cannot register input events more than %d."), FInputBufferRecord::MAX_EVENTS);
+				break;
+			}
+
+			if (!Setup.XAxis.IsValid() || !Setup.YAxis.IsValid())
+			{
+				UE_LOG(InputBufferLog, Warning, TEXT("Input stick '%s' does not have valid axes."), *Setup.Name.ToString());
+				continue;
+			}
+
+			// Directions are registered all together or not at all, so that they stay consecutive.
+			FName DirectionEvents[FCompiledInputStick::NUM_DIRECTIONS];
+			bool bConflict = false;
+			for (int32 Direction = 0; Direction < FCompiledInputStick::NUM_DIRECTIONS; Direction++)
+			{
+				DirectionEvents[Direction] = FName(*(Setup.Name.ToString() + StickDirectionNames[Direction]));
+				bConflict |= EventIndexMap.Find(DirectionEvents[Direction]) != nullptr;
+			}
+
+			if (bConflict)
+			{
+				UE_LOG(InputBufferLog, Warning, TEXT("Direction events of input stick '%s' conflict with other input events."), *Setup.Name.ToString());
+				continue;
+			}
+
+			FCompiledInputStick& Stick = Schema->Sticks.AddDefaulted_GetRef();
+			Stick.XAxis = Setup.XAxis;
+			Stick.YAxis = Setup.YAxis;
+			Stick.DeadZone = Setup.DeadZone;
+			Stick.ReleaseDeadZone = FMath::Max(Setup.DeadZone - Setup.DeadZoneHysteresis, 0.f);
+			Stick.AngleHysteresis = Setup.AngleHysteresis;
+			Stick.FirstEvent = RuntimeEvents.Num();
+			Stick.FirstKey = INDEX_NONE;
+
+			for (FName Name : DirectionEvents)
+			{
+				FBufferedInputEventSetup Event;
+				Event.Name = Name;
+				Event.Type = Setup.Type;
+				Event.bExecuteWhenPaused = Setup.bExecuteWhenPaused;
+				EventIndexMap.Add(Name, RuntimeEvents.Add(Event));
+			}
+		}
+	}
+
+	for (FName Event : TranslatedEvents)
+	{
+		if (Event != NAME_None && EventIndexMap.Find(Event) == nullptr)
+		{
+			if (RuntimeEvents.Num() >= FInputBufferRecord::MAX_EVENTS)
+			{
+				UE_LOG(InputBufferLog, Warning, TEXT("Cannot register input events more than %d."), FInputBufferRecord::MAX_EVENTS);
+				break;
+			}
+
+			FBufferedInputEventSetup Setup;
+			Setup.Name = Event;
+			int32 Index = RuntimeEvents.Add(Setup);
+			EventIndexMap.Add(Setup.Name, Index);
+		}
+	}
+
+	// Virtual keys of stick directions follow the bound keys.
+	int32 NumKeys = RuntimeKeys.Num();
+	for (FCompiledInputStick& Stick : Schema->Sticks)
+	{
+		Stick.FirstKey = NumKeys;
+		NumKeys += FCompiledInputStick::NUM_DIRECTIONS;
+	}
+
+	// Precompute key bits of every event so that processing input needs no key lookup.
+	const int32 NumKeyWords = (NumKeys + 63) / 64;
+	Schema->NumKeyWords = NumKeyWords;
+	Schema->EventKeyMasks.Init(0, RuntimeEvents.Num() * NumKeyWords);
+
+	for (int32 EventIdx = 0; EventIdx < RuntimeEvents.Num(); EventIdx++)
+	{
+		const auto& Event = RuntimeEvents[EventIdx];
+		uint64* Mask = Schema->EventKeyMasks.GetData() + EventIdx * NumKeyWords;
+		for (const FKey& Key : Event.Keys)
+		{
+			const int32 KeyIdx = KeyIndexMap.FindChecked(Key);
+			Mask[KeyIdx >> 6] |= (1ULL << (KeyIdx & 63));
+		}
+
+		if (Event.bExecuteWhenPaused)
+		{
+			Schema->PausedEventMask.SetBit(EventIdx);
+		}
+	}
+
+	for (const FCompiledInputStick& Stick : Schema->Sticks)
+	{
+		for (int32 Direction = 0; Direction < FCompiledInputStick::NUM_DIRECTIONS; Direction++)
+		{
+			const int32 KeyIdx = Stick.FirstKey + Direction;
+			Schema->EventKeyMasks[(Stick.FirstEvent + Direction) * NumKeyWords + (KeyIdx >> 6)] |= (1ULL << (KeyIdx & 63));
+		}
+	}
+
+	Schema->EventNameStrings.Reserve(RuntimeEvents.Num());
+	for (const auto& Event : RuntimeEvents)
+	{
+		Schema->EventNameStrings.Add(Event.Name.ToString());
+	}
+
+	for (const UInputCommand* Command : Commands)
+	{
+		if (Command && Schema->Commands.Find(Command) == nullptr)
+		{
+			Schema->Commands.Add(Command).Compile(*Command, EventIndexMap);
+		}
+	}
+
+	return Schema;
+}
+
+//////////////////////////////////////////////////////////////////////////
+// UInputBufferSchema
+
+TSharedRef<const FCompiledInputBufferSchema> UInputBufferSchema::GetCompiledSchema() const
+{
+	if (!CompiledSchema.IsValid())
+	{
+		CompiledSchema = FCompiledInputBufferSchema::Compile(EventSetups, StickSetups, TranslatedEvents, KeyMappings, Commands);
+	}
+
+	return CompiledSchema.ToSharedRef();
+}
+
+void UInputBufferSchema::InvalidateCompiledSchema()
+{
+	CompiledSchema.Reset();
+}
+
+#if WITH_EDITOR
+void UInputBufferSchema::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	InvalidateCompiledSchema();
+}
+#endif
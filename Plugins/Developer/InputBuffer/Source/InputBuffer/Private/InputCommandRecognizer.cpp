@@ -0,0 +1,437 @@
+// Copyright 2018 Isaac Hsu.
+
+#include "InputCommandRecognizer.h"
+
+#include "BufferedInputEventKit.h"
+#include "InputBufferSnapshot.h"
+
+namespace InputCommandRecognizer
+{
+	/* Returns whether given events match an entry. */
+	static FORCEINLINE bool Matches(const FCompiledInputCommandEntry& Entry, const FInputEventFlags& Events)
+	{
+		return Entry.bIgnoreOthers
+			? FBufferedInputEventKit::HasEventFlags(Events, Entry.MatchFlags)
+			: FBufferedInputEventKit::CompareEventFlags(Events, Entry.MatchFlags, Entry.IgnoreFlags);
+	}
+
+	/* Returns whether a record with given events can lie between the run of an entry and the run of the next one. */
+	static FORCEINLINE bool IsSkippable(const FCompiledInputCommandEntry& Entry, const FInputEventFlags& Events)
+	{
+		return !Matches(Entry, Events) && (Events.IsZero() || Entry.bIgnoreOthers || Events.IsSubsetOf(Entry.IgnoreFlags));
+	}
+
+	/* Shortens the first run of a thread if only its beginning is older than OldestSerial. Returns false if the whole first run is older. */
+	static FORCEINLINE bool TruncateThread(FInputCommandThread& Thread, int64 OldestSerial, const FInputBufferRecord& OldestRecord)
+	{
+		if (Thread.FirstEndSerial < OldestSerial)
+		{
+			return false;
+		}
+		if (Thread.FirstStartSerial < OldestSerial)
+		{
+			Thread.FirstStartSerial = OldestSerial;
+			Thread.FirstStartTime = OldestRecord.StartTime;
+			if (Thread.bInRun && Thread.EntryIdx == 0)
+			{
+				Thread.MarkSerial = OldestSerial;
+				Thread.RunStartTime = OldestRecord.StartTime;
+			}
+		}
+
+		return true;
+	}
+}
+
+FInputCommandRecognizer::FInputCommandRecognizer()
+	: LastSerial(INDEX_NONE)
+	, bLastValid(false)
+{
+}
+
+void FInputCommandRecognizer::SetCommands(TArray<FCompiledInputCommand>&& InCommands)
+{
+	Commands = MoveTemp(InCommands);
+
+	Sequences.Reset();
+	for (int32 CommandIdx = 0; CommandIdx < Commands.Num(); CommandIdx++)
+	{
+		for (const FCompiledInputCommandSequence& Sequence : Commands[CommandIdx].Sequences)
+		{
+			Sequences.Add({ CommandIdx, Sequence.FirstEntry, Sequence.NumEntries, 0 });
+		}
+	}
+
+	Threads.SetNumUninitialized(Sequences.Num() * MAX_THREADS_PER_SEQUENCE);
+	Matched.Init(false, Commands.Num());
+	NewlyMatched.Init(false, Commands.Num());
+
+	ResetProgress();
+}
+
+void FInputCommandRecognizer::ResetProgress()
+{
+	for (FSequence& Sequence : Sequences)
+	{
+		Sequence.NumThreads = 0;
+	}
+
+	Matched.Init(false, Commands.Num());
+	NewlyMatched.Init(false, Commands.Num());
+
+	LastSerial = INDEX_NONE;
+	LastEvents = FInputEventFlags();
+	bLastValid = false;
+}
+
+void FInputCommandRecognizer::PushRecord(const FInputBufferRecord& Record, int32 NumRetained, const FInputBufferRecord& OldestRecord)
+{
+	LastSerial++;
+
+	for (int32 SequenceIdx = 0; SequenceIdx < Sequences.Num(); SequenceIdx++)
+	{
+		AdvanceSequence(SequenceIdx, Record, NumRetained, OldestRecord);
+	}
+
+	LastEvents = Record.Events;
+	bLastValid = Record.bValid;
+}
+
+void FInputCommandRecognizer::ExtendRecord(const FInputBufferRecord& Record)
+{
+	if (LastSerial == INDEX_NONE || !bLastValid)
+	{
+		return; // because no thread can contain the record
+	}
+
+	for (int32 SequenceIdx = 0; SequenceIdx < Sequences.Num(); SequenceIdx++)
+	{
+		FInputCommandThread* SequenceThreads = GetThreads(SequenceIdx);
+		for (int32 Idx = 0; Idx < Sequences[SequenceIdx].NumThreads; Idx++)
+		{
+			FInputCommandThread& Thread = SequenceThreads[Idx];
+			if (Thread.bInRun)
+			{
+				Thread.RunEndTime = Record.EndTime;
+				if (Thread.EntryIdx == 0)
+				{
+					Thread.FirstEndTime = Record.EndTime;
+				}
+			}
+		}
+	}
+}
+
+void FInputCommandRecognizer::DiscardOlderRecords(int32 NumRemaining, const FInputBufferRecord& OldestRemaining)
+{
+	using namespace InputCommandRecognizer;
+
+	if (LastSerial == INDEX_NONE)
+	{
+		return;
+	}
+
+	if (NumRemaining <= 0)
+	{
+		// Keep LastSerial so that serials of later records still increase.
+		for (FSequence& Sequence : Sequences)
+		{
+			Sequence.NumThreads = 0;
+		}
+		bLastValid = false;
+		return;
+	}
+
+	// Discarded records are the same as overwritten ones to partial matches.
+	const int64 OldestSerial = LastSerial - NumRemaining + 1;
+	for (int32 SequenceIdx = 0; SequenceIdx < Sequences.Num(); SequenceIdx++)
+	{
+		FSequence& Sequence = Sequences[SequenceIdx];
+		FInputCommandThread* SequenceThreads = GetThreads(SequenceIdx);
+		for (int32 Idx = 0; Idx < Sequence.NumThreads;)
+		{
+			if (TruncateThread(SequenceThreads[Idx], OldestSerial, OldestRemaining))
+			{
+				Idx++;
+			}
+			else
+			{
+				SequenceThreads[Idx] = SequenceThreads[--Sequence.NumThreads];
+			}
+		}
+	}
+}
+
+void FInputCommandRecognizer::AdvanceSequence(int32 SequenceIdx, const FInputBufferRecord& Record, int32 NumRetained, const FInputBufferRecord& OldestRecord)
+{
+	using namespace InputCommandRecognizer;
+
+	FSequence& Sequence = Sequences[SequenceIdx];
+	FInputCommandThread* SequenceThreads = GetThreads(SequenceIdx);
+
+	if (!Record.bValid || Sequence.NumEntries == 0)
+	{
+		Sequence.NumThreads = 0; // because no match can contain an invalid record
+		return;
+	}
+
+	const FCompiledInputCommandEntry* Entries = Commands[Sequence.CommandIdx].Entries.GetData() + Sequence.FirstEntry;
+	const int32 LastEntryIdx = Sequence.NumEntries - 1;
+	const int64 OldestSerial = LastSerial - NumRetained + 1;
+	const bool bHasPrev = bLastValid && LastSerial > 0 && NumRetained > 1; // Whether the previous record can take part in a match.
+
+	// A run must contain every consecutive record matching its entry, so it can only start where the previous record does not match.
+	auto CanStartRun = [&](const FCompiledInputCommandEntry& Entry) -> bool
+	{
+		return Matches(Entry, Record.Events) && !(bHasPrev && Matches(Entry, LastEvents));
+	};
+
+	FInputCommandThread Next[MAX_THREADS_PER_SEQUENCE * 2 + 1];
+	int32 NumNext = 0;
+
+	auto StartRun = [&](const FInputCommandThread& From, int32 EntryIdx)
+	{
+		FInputCommandThread& Thread = Next[NumNext++] = From;
+		Thread.EntryIdx = EntryIdx;
+		Thread.bInRun = true;
+		Thread.MarkSerial = LastSerial;
+		Thread.RunStartTime = Record.StartTime;
+		Thread.RunEndTime = Record.EndTime;
+		if (EntryIdx == 0)
+		{
+			Thread.FirstStartSerial = LastSerial;
+			Thread.FirstEndSerial = LastSerial;
+			Thread.FirstStartTime = Record.StartTime;
+			Thread.FirstEndTime = Record.EndTime;
+		}
+	};
+
+	auto SkipRecord = [&](const FInputCommandThread& From, int32 EntryIdx)
+	{
+		FInputCommandThread& Thread = Next[NumNext++] = From;
+		if (Thread.bInRun)
+		{
+			Thread.bInRun = false;
+			Thread.MarkSerial = LastSerial - 1; // The previous run ends at the previous record.
+		}
+		Thread.EntryIdx = EntryIdx;
+	};
+
+	for (int32 Idx = 0; Idx < Sequence.NumThreads; Idx++)
+	{
+		FInputCommandThread& Thread = SequenceThreads[Idx];
+
+		// Drop threads whose first run has been overwritten, and shorten the first run if only its beginning has been overwritten.
+		if (!TruncateThread(Thread, OldestSerial, OldestRecord))
+		{
+			continue;
+		}
+
+		if (Thread.bInRun)
+		{
+			const FCompiledInputCommandEntry& Entry = Entries[Thread.EntryIdx];
+
+			// Prolong the current run.
+			if (Matches(Entry, Record.Events))
+			{
+				FInputCommandThread& Prolonged = Next[NumNext++] = Thread;
+				Prolonged.RunEndTime = Record.EndTime;
+				if (Prolonged.EntryIdx == 0)
+				{
+					Prolonged.FirstEndSerial = LastSerial;
+					Prolonged.FirstEndTime = Record.EndTime;
+				}
+			}
+
+			// Alternatively, end the current run at the previous record.
+			// The duration of the first entry is checked on completion since overwriting records may still shorten it.
+			if (Thread.EntryIdx > 0 && !Entry.CheckDuration(Thread.RunEndTime - Thread.RunStartTime))
+			{
+				continue;
+			}
+
+			if (Thread.EntryIdx < LastEntryIdx && CanStartRun(Entries[Thread.EntryIdx + 1]) && Entry.CheckInterval(Record.StartTime - Thread.RunEndTime))
+			{
+				StartRun(Thread, Thread.EntryIdx + 1);
+			}
+
+			if (IsSkippable(Entry, Record.Events))
+			{
+				SkipRecord(Thread, Thread.EntryIdx + 1);
+			}
+		}
+		else
+		{
+			// Records in the gap before the run of an entry are checked against the previous entry.
+			const FCompiledInputCommandEntry& PrevEntry = Entries[Thread.EntryIdx - 1];
+
+			if (Thread.EntryIdx <= LastEntryIdx && CanStartRun(Entries[Thread.EntryIdx]) && PrevEntry.CheckInterval(Record.StartTime - Thread.RunEndTime))
+			{
+				StartRun(Thread, Thread.EntryIdx);
+			}
+
+			if (IsSkippable(PrevEntry, Record.Events))
+			{
+				SkipRecord(Thread, Thread.EntryIdx);
+			}
+		}
+	}
+
+	if (CanStartRun(Entries[0]))
+	{
+		StartRun(FInputCommandThread(), 0);
+	}
+
+	// Keep distinct threads only. If there are too many, drop the ones with the oldest input since they are the first to exceed the time limit.
+	Sequence.NumThreads = 0;
+	for (int32 Idx = 0; Idx < NumNext; Idx++)
+	{
+		const FInputCommandThread& Candidate = Next[Idx];
+
+		int32 Slot = INDEX_NONE;
+		for (int32 Existing = 0; Existing < Sequence.NumThreads; Existing++)
+		{
+			const FInputCommandThread& Thread = SequenceThreads[Existing];
+			if (Thread.EntryIdx == Candidate.EntryIdx && Thread.bInRun == Candidate.bInRun && Thread.MarkSerial == Candidate.MarkSerial)
+			{
+				Slot = (Thread.FirstEndSerial < Candidate.FirstEndSerial) ? Existing : MAX_int32;
+				break;
+			}
+		}
+
+		if (Slot == INDEX_NONE)
+		{
+			if (Sequence.NumThreads < MAX_THREADS_PER_SEQUENCE)
+			{
+				Slot = Sequence.NumThreads++;
+			}
+			else
+			{
+				Slot = 0;
+				for (int32 Existing = 1; Existing < Sequence.NumThreads; Existing++)
+				{
+					if (SequenceThreads[Existing].FirstEndSerial < SequenceThreads[Slot].FirstEndSerial)
+					{
+						Slot = Existing;
+					}
+				}
+
+				if (SequenceThreads[Slot].FirstEndSerial >= Candidate.FirstEndSerial)
+				{
+					Slot = MAX_int32;
+				}
+			}
+		}
+
+		if (Slot != MAX_int32)
+		{
+			SequenceThreads[Slot] = Candidate;
+		}
+	}
+}
+
+bool FInputCommandRecognizer::Evaluate(float CurrTime)
+{
+	// Keep the previous results in NewlyMatched until the new ones are decided.
+	for (int32 CommandIdx = 0; CommandIdx < Commands.Num(); CommandIdx++)
+	{
+		NewlyMatched[CommandIdx] = Matched[CommandIdx];
+		Matched[CommandIdx] = false;
+	}
+
+	for (int32 SequenceIdx = 0; SequenceIdx < Sequences.Num(); SequenceIdx++)
+	{
+		if (EvaluateSequence(SequenceIdx, CurrTime))
+		{
+			Matched[Sequences[SequenceIdx].CommandIdx] = true;
+		}
+	}
+
+	bool bAnyNewlyMatched = false;
+	for (int32 CommandIdx = 0; CommandIdx < Commands.Num(); CommandIdx++)
+	{
+		const bool bNewlyMatched = Matched[CommandIdx] && !NewlyMatched[CommandIdx];
+		NewlyMatched[CommandIdx] = bNewlyMatched;
+		bAnyNewlyMatched |= bNewlyMatched;
+	}
+
+	return bAnyNewlyMatched;
+}
+
+bool FInputCommandRecognizer::EvaluateSequence(int32 SequenceIdx, float CurrTime)
+{
+	FSequence& Sequence = Sequences[SequenceIdx];
+	if (Sequence.NumEntries == 0)
+	{
+		return LastSerial != INDEX_NONE; // because of nothing to match
+	}
+
+	const FCompiledInputCommand& Command = Commands[Sequence.CommandIdx];
+	const FCompiledInputCommandEntry* Entries = Command.Entries.GetData() + Sequence.FirstEntry;
+	const int32 LastEntryIdx = Sequence.NumEntries - 1;
+	FInputCommandThread* SequenceThreads = GetThreads(SequenceIdx);
+
+	bool bMatched = false;
+	for (int32 Idx = 0; Idx < Sequence.NumThreads;)
+	{
+		const FInputCommandThread& Thread = SequenceThreads[Idx];
+		const bool bInFirstRun = Thread.bInRun && Thread.EntryIdx == 0;
+
+		// Drop threads which can never satisfy the time limit or the maximal duration of the current entry.
+		const bool bTimedOut = !bInFirstRun && Command.TimeLimit != 0.f && CurrTime - Thread.FirstEndTime > Command.TimeLimit;
+		const bool bTooLong = Thread.bInRun && !bInFirstRun && Entries[Thread.EntryIdx].MaxDuration != 0.f
+			&& Thread.RunEndTime - Thread.RunStartTime > Entries[Thread.EntryIdx].MaxDuration;
+		if (bTimedOut || bTooLong)
+		{
+			SequenceThreads[Idx] = SequenceThreads[--Sequence.NumThreads];
+			continue;
+		}
+
+		if (!bMatched)
+		{
+			const bool bComplete = Thread.bInRun
+				? (Thread.EntryIdx == LastEntryIdx && Entries[LastEntryIdx].CheckDuration(Thread.RunEndTime - Thread.RunStartTime))
+				: Thread.EntryIdx == LastEntryIdx + 1;
+
+			bMatched = bComplete
+				&& Entries[0].CheckDuration(Thread.FirstEndTime - Thread.FirstStartTime)
+				&& (Command.TimeLimit == 0.f || CurrTime - Thread.FirstEndTime <= Command.TimeLimit);
+		}
+
+		Idx++;
+	}
+
+	return bMatched;
+}
+
+int32 FInputCommandRecognizer::GetSnapshotSize() const
+{
+	const int32 NumMatchedWords = FMath::DivideAndRoundUp(Matched.Num(), (int32)NumBitsPerDWORD);
+	return Sequences.Num() * sizeof(FSequence) + Threads.Num() * sizeof(FInputCommandThread) + 2 * NumMatchedWords * sizeof(uint32)
+		+ sizeof(LastSerial) + sizeof(LastEvents) + sizeof(bLastValid);
+}
+
+void FInputCommandRecognizer::SaveSnapshot(uint8* Data) const
+{
+	// Sequences carry the thread counts. Thread slots are copied as a whole, including unused ones, so that it takes a single memcpy.
+	const int32 NumMatchedWords = FMath::DivideAndRoundUp(Matched.Num(), (int32)NumBitsPerDWORD);
+	InputBufferSnapshot::Write(Data, Sequences.GetData(), Sequences.Num());
+	InputBufferSnapshot::Write(Data, Threads.GetData(), Threads.Num());
+	InputBufferSnapshot::Write(Data, Matched.GetData(), NumMatchedWords);
+	InputBufferSnapshot::Write(Data, NewlyMatched.GetData(), NumMatchedWords);
+	InputBufferSnapshot::Write(Data, &LastSerial, 1);
+	InputBufferSnapshot::Write(Data, &LastEvents, 1);
+	InputBufferSnapshot::Write(Data, &bLastValid, 1);
+}
+
+void FInputCommandRecognizer::RestoreSnapshot(const uint8* Data)
+{
+	const int32 NumMatchedWords = FMath::DivideAndRoundUp(Matched.Num(), (int32)NumBitsPerDWORD);
+	InputBufferSnapshot::Read(Data, Sequences.GetData(), Sequences.Num());
+	InputBufferSnapshot::Read(Data, Threads.GetData(), Threads.Num());
+	InputBufferSnapshot::Read(Data, Matched.GetData(), NumMatchedWords);
+	InputBufferSnapshot::Read(Data, NewlyMatched.GetData(), NumMatchedWords);
+	InputBufferSnapshot::Read(Data, &LastSerial, 1);
+	InputBufferSnapshot::Read(Data, &LastEvents, 1);
+	InputBufferSnapshot::Read(Data, &bLastValid, 1);
+}
@@ -0,0 +1,389 @@
+// Copyright 2018 Isaac Hsu.
+
+#include "InputCommandSetMatcher.h"
+
+#include "BufferedInputEventKit.h"
+
+namespace InputCommandSetMatcher
+{
+	/* Returns whether two entries test the same events with the same limits. */
+	static bool AreEntriesEqual(const FCompiledInputCommandEntry& A, const FCompiledInputCommandEntry& B)
+	{
+		return A.MatchFlags == B.MatchFlags && A.IgnoreFlags == B.IgnoreFlags && A.bIgnoreOthers == B.bIgnoreOthers
+			&& A.MinDuration == B.MinDuration && A.MaxDuration == B.MaxDuration && A.MinInterval == B.MinInterval && A.MaxInterval == B.MaxInterval;
+	}
+}
+
+FInputCommandSetMatcher::FInputCommandSetMatcher()
+	: FirstUndecided(0)
+	, MaxStepWork(0)
+{
+}
+
+void FInputCommandSetMatcher::Reset()
+{
+	Tests.Reset();
+	Nodes.Reset();
+	Roots.Reset();
+	Commands.Reset();
+	Sequences.Reset();
+	Results.Reset();
+	Tokens.Reset();
+}
+
+void FInputCommandSetMatcher::AddCommand(const FCompiledInputCommand* Command)
+{
+	const int32 CommandIdx = Commands.Add({ Sequences.Num(), 0 });
+	if (Command == nullptr)
+	{
+		return;
+	}
+
+	Commands[CommandIdx].NumSequences = Command->Sequences.Num();
+
+	for (const FCompiledInputCommandSequence& Sequence : Command->Sequences)
+	{
+		// Entries are matched from the last one, so sequences ending with the same entries share a path from a root.
+		int32 NodeIdx = INDEX_NONE;
+		for (int32 EntryIdx = Sequence.NumEntries - 1; EntryIdx >= 0; EntryIdx--)
+		{
+			NodeIdx = FindOrAddNode(NodeIdx, Command->Entries[Sequence.FirstEntry + EntryIdx], Command->TimeLimit);
+			Nodes[NodeIdx].NumSequences++;
+		}
+
+		const int32 SequenceIdx = Sequences.Add({ CommandIdx, NodeIdx });
+		if (NodeIdx != INDEX_NONE)
+		{
+			Nodes[NodeIdx].Terminals.Add(SequenceIdx);
+		}
+	}
+}
+
+int32 FInputCommandSetMatcher::FindOrAddNode(int32 Parent, const FCompiledInputCommandEntry& Entry, float TimeLimit)
+{
+	const TArray<int32, TInlineAllocator<4>>* Siblings = Parent != INDEX_NONE ? &Nodes[Parent].Children : nullptr;
+	const int32 NumSiblings = Siblings ? Siblings->Num() : Roots.Num();
+	for (int32 Idx = 0; Idx < NumSiblings; Idx++)
+	{
+		const int32 NodeIdx = Siblings ? (*Siblings)[Idx] : Roots[Idx];
+		const FNode& Node = Nodes[NodeIdx];
+		if (Node.TimeLimit == TimeLimit && InputCommandSetMatcher::AreEntriesEqual(*Node.Entry, Entry))
+		{
+			return NodeIdx;
+		}
+	}
+
+	const int32 TestIdx = FindOrAddTest(Entry);
+
+	const int32 NodeIdx = Nodes.AddDefaulted();
+	FNode& Node = Nodes[NodeIdx];
+	Node.Entry = &Entry;
+	Node.TimeLimit = TimeLimit;
+	Node.TestIdx = TestIdx;
+	Node.Parent = Parent;
+	Node.NumSequences = 0;
+
+	if (Parent != INDEX_NONE)
+	{
+		Nodes[Parent].Children.Add(NodeIdx);
+	}
+	else
+	{
+		Roots.Add(NodeIdx);
+	}
+
+	return NodeIdx;
+}
+
+int32 FInputCommandSetMatcher::FindOrAddTest(const FCompiledInputCommandEntry& Entry)
+{
+	for (int32 TestIdx = 0; TestIdx < Tests.Num(); TestIdx++)
+	{
+		const FTest& Test = Tests[TestIdx];
+		if (Test.MatchFlags == Entry.MatchFlags && Test.IgnoreFlags == Entry.IgnoreFlags && Test.bIgnoreOthers == Entry.bIgnoreOthers)
+		{
+			return TestIdx;
+		}
+	}
+
+	return Tests.Add({ Entry.MatchFlags, Entry.IgnoreFlags, Entry.bIgnoreOthers });
+}
+
+void FInputCommandSetMatcher::Begin()
+{
+	Results.Init(EInputCommandMatchResult::Failed, Commands.Num());
+	PendingSequences.SetNumUninitialized(Commands.Num());
+	for (int32 CommandIdx = 0; CommandIdx < Commands.Num(); CommandIdx++)
+	{
+		PendingSequences[CommandIdx] = Commands[CommandIdx].NumSequences;
+		if (Commands[CommandIdx].NumSequences > 0)
+		{
+			Results[CommandIdx] = EInputCommandMatchResult::Pending;
+		}
+	}
+
+	LiveSequences.SetNumUninitialized(Nodes.Num());
+	for (int32 NodeIdx = 0; NodeIdx < Nodes.Num(); NodeIdx++)
+	{
+		LiveSequences[NodeIdx] = Nodes[NodeIdx].NumSequences;
+	}
+
+	DecidedSequences.Init(false, Sequences.Num());
+	TestResults.SetNumUninitialized(Tests.Num());
+	FirstUndecided = 0;
+	MaxStepWork = 0;
+
+	for (int32 SequenceIdx = 0; SequenceIdx < Sequences.Num(); SequenceIdx++)
+	{
+		if (Sequences[SequenceIdx].Terminal == INDEX_NONE)
+		{
+			DecideSequence(SequenceIdx, EInputCommandMatchResult::Matched); // because of nothing to match
+		}
+	}
+
+	Tokens.Reset();
+	for (int32 NodeIdx : Roots)
+	{
+		Tokens.Add({ NodeIdx, false, 0.f, 0.f, 0.f, 0.f });
+	}
+}
+
+bool FInputCommandSetMatcher::Step(const FInputBufferRecord& Record, float CurrTime)
+{
+	if (Tokens.Num() == 0)
+	{
+		return false;
+	}
+
+	if (!Record.bValid)
+	{
+		Finish(); // Need not check the previous records since they should be invalid too.
+		return false;
+	}
+
+	if (TestResults.Num() > 0)
+	{
+		FMemory::Memzero(TestResults.GetData(), TestResults.Num());
+	}
+
+	int32 Work = 0;
+	NextTokens.Reset();
+	for (const FToken& Token : Tokens)
+	{
+		Worklist.Add(Token);
+		while (Worklist.Num() > 0)
+		{
+			FToken Curr = Worklist.Pop(false);
+			if (StepToken(Curr, Record, CurrTime, Work))
+			{
+				NextTokens.Add(Curr);
+			}
+		}
+	}
+	Swap(Tokens, NextTokens);
+
+	MaxStepWork = FMath::Max(MaxStepWork, Work);
+	return Tokens.Num() > 0;
+}
+
+bool FInputCommandSetMatcher::StepToken(FToken& Token, const FInputBufferRecord& Record, float CurrTime, int32& Work)
+{
+	// The same record may be tried with several entries, but each iteration either consumes the record or moves to the previous entries.
+	for (;;)
+	{
+		if (LiveSequences[Token.NodeIdx] == 0)
+		{
+			return false; // because every sequence through the node has been decided
+		}
+
+		const FNode& Node = Nodes[Token.NodeIdx];
+		Work++;
+
+		if (CurrTime - Record.EndTime > Node.TimeLimit && Node.TimeLimit != 0.f && !Token.bRepeating)
+		{
+			FailSubtree(Token.NodeIdx);
+			return false;
+		}
+
+		const uint8 TestResult = GetTestResult(Node.TestIdx, Record, Work);
+
+		if (TestResult & TEST_MATCHED)
+		{
+			if (Token.CurrEntryEndTime == 0)
+			{
+				// Check limits of the duration of the next entry.
+				if (Token.PrevEntryEndTime != 0.f && !Nodes[Node.Parent].Entry->CheckDuration(Token.PrevEntryEndTime - Token.PrevEntryStartTime))
+				{
+					FailSubtree(Token.NodeIdx);
+					return false;
+				}
+
+				// Check limits of the interval between the current entry and the next entry.
+				if (Token.PrevEntryStartTime != 0.f && !Node.Entry->CheckInterval(Token.PrevEntryStartTime - Record.EndTime))
+				{
+					FailSubtree(Token.NodeIdx);
+					return false;
+				}
+
+				Token.CurrEntryEndTime = Record.EndTime;
+			}
+			Token.CurrEntryStartTime = Record.StartTime;
+
+			Token.bRepeating = true;
+			return true;
+		}
+		else if (Token.bRepeating)
+		{
+			// Sequences starting with this entry have found matching records for all entries.
+			const EInputCommandMatchResult Result = Node.Entry->CheckDuration(Token.CurrEntryEndTime - Token.CurrEntryStartTime) ? EInputCommandMatchResult::Matched : EInputCommandMatchResult::Failed;
+			for (int32 SequenceIdx : Node.Terminals)
+			{
+				DecideSequence(SequenceIdx, Result);
+			}
+
+			if (Node.Children.Num() == 0)
+			{
+				return false;
+			}
+
+			Token.bRepeating = false;
+			if (Token.CurrEntryEndTime != 0)
+			{
+				Token.PrevEntryStartTime = Token.CurrEntryStartTime;
+				Token.PrevEntryEndTime = Token.CurrEntryEndTime;
+				Token.CurrEntryStartTime = 0.f;
+				Token.CurrEntryEndTime = 0.f;
+			}
+
+			// Try the same record with the previous entries.
+			for (int32 Idx = 1; Idx < Node.Children.Num(); Idx++)
+			{
+				FToken& Fork = Worklist.Add_GetRef(Token);
+				Fork.NodeIdx = Node.Children[Idx];
+			}
+			Token.NodeIdx = Node.Children[0];
+		}
+		else if (TestResult & TEST_SKIPPABLE)
+		{
+			// Skip the current record when there is no input, or the input events do not match but are all neglectable.
+			return true;
+		}
+		else
+		{
+			FailSubtree(Token.NodeIdx); // Fails due to mismatch.
+			return false;
+		}
+	}
+}
+
+uint8 FInputCommandSetMatcher::GetTestResult(int32 TestIdx, const FInputBufferRecord& Record, int32& Work)
+{
+	uint8& Result = TestResults[TestIdx];
+	if (Result == 0)
+	{
+		const FTest& Test = Tests[TestIdx];
+		const bool bMatched = Test.bIgnoreOthers
+			? FBufferedInputEventKit::HasEventFlags(Record.Events, Test.MatchFlags)
+			: FBufferedInputEventKit::CompareEventFlags(Record.Events, Test.MatchFlags, Test.IgnoreFlags);
+		const bool bSkippable = Record.Events.IsZero() || Test.bIgnoreOthers || Record.Events.IsSubsetOf(Test.IgnoreFlags);
+
+		Result = TEST_EVALUATED | (bMatched ? TEST_MATCHED : 0) | (bSkippable ? TEST_SKIPPABLE : 0);
+		Work++;
+	}
+
+	return Result;
+}
+
+void FInputCommandSetMatcher::Finish()
+{
+	for (const FToken& Token : Tokens)
+	{
+		FinishToken(Token);
+	}
+	Tokens.Reset();
+}
+
+void FInputCommandSetMatcher::FinishToken(const FToken& Token)
+{
+	if (LiveSequences[Token.NodeIdx] == 0)
+	{
+		return;
+	}
+
+	// Succeeds only for sequences starting with the entry being repeated, which means all the other entries have been matched.
+	const FNode& Node = Nodes[Token.NodeIdx];
+	const bool bMatched = Token.bRepeating && Node.Entry->CheckDuration(Token.CurrEntryEndTime - Token.CurrEntryStartTime);
+	for (int32 SequenceIdx : Node.Terminals)
+	{
+		DecideSequence(SequenceIdx, bMatched ? EInputCommandMatchResult::Matched : EInputCommandMatchResult::Failed);
+	}
+
+	FailSubtree(Token.NodeIdx);
+}
+
+void FInputCommandSetMatcher::DecideSequence(int32 SequenceIdx, EInputCommandMatchResult Result)
+{
+	if (DecidedSequences[SequenceIdx])
+	{
+		return;
+	}
+	DecidedSequences[SequenceIdx] = true;
+
+	const FSequence& Sequence = Sequences[SequenceIdx];
+	for (int32 NodeIdx = Sequence.Terminal; NodeIdx != INDEX_NONE; NodeIdx = Nodes[NodeIdx].Parent)
+	{
+		LiveSequences[NodeIdx]--;
+	}
+
+	if (Results[Sequence.CommandIdx] != EInputCommandMatchResult::Pending)
+	{
+		return; // because another sequence has already matched
+	}
+
+	if (Result == EInputCommandMatchResult::Matched)
+	{
+		Results[Sequence.CommandIdx] = EInputCommandMatchResult::Matched;
+
+		// The other sequences of the command need no more records.
+		const FCommand& Command = Commands[Sequence.CommandIdx];
+		for (int32 Idx = Command.FirstSequence; Idx < Command.FirstSequence + Command.NumSequences; Idx++)
+		{
+			DecideSequence(Idx, EInputCommandMatchResult::Failed);
+		}
+	}
+	else if (--PendingSequences[Sequence.CommandIdx] == 0)
+	{
+		Results[Sequence.CommandIdx] = EInputCommandMatchResult::Failed;
+	}
+}
+
+void FInputCommandSetMatcher::FailSubtree(int32 NodeIdx)
+{
+	TArray<int32, TInlineAllocator<32>> Stack;
+	Stack.Add(NodeIdx);
+	while (Stack.Num() > 0)
+	{
+		const FNode& Node = Nodes[Stack.Pop(false)];
+		for (int32 SequenceIdx : Node.Terminals)
+		{
+			DecideSequence(SequenceIdx, EInputCommandMatchResult::Failed);
+		}
+		for (int32 ChildIdx : Node.Children)
+		{
+			if (LiveSequences[ChildIdx] > 0)
+			{
+				Stack.Add(ChildIdx);
+			}
+		}
+	}
+}
+
+int32 FInputCommandSetMatcher::FindFirstMatched()
+{
+	while (FirstUndecided < Results.Num() && Results[FirstUndecided] == EInputCommandMatchResult::Failed)
+	{
+		FirstUndecided++;
+	}
+
+	return (FirstUndecided < Results.Num() && Results[FirstUndecided] == EInputCommandMatchResult::Matched) ? FirstUndecided : INDEX_NONE;
+}
@@ -0,0 +1,259 @@
+// Copyright 2018 Isaac Hsu.
+
+#include "InputHistory.h"
+
+#include "InputBufferSnapshot.h"
+
+static_assert(sizeof(FInputEventFlags) == FInputEventFlags::NUM_WORDS * sizeof(uint64), "Event flags must be scannable as a flat array of words.");
+
+namespace InputHistory
+{
+	/* Returns the index of the last non-zero word in [Begin, End), or INDEX_NONE. Scans 128 bits at a time with SSE2 where available. */
+	int32 FindLastNonZeroWord(const uint64* Words, int32 Begin, int32 End)
+	{
+		int32 Idx = End;
+#if INPUTBUFFER_SSE_EVENT_FLAGS
+		const __m128i Zero = _mm_setzero_si128();
+		for (; Idx - 2 >= Begin; Idx -= 2)
+		{
+			const __m128i Pair = _mm_loadu_si128((const __m128i*)(Words + Idx - 2));
+			if (_mm_movemask_epi8(_mm_cmpeq_epi32(Pair, Zero)) != 0xFFFF)
+			{
+				return Words[Idx - 1] != 0 ? Idx - 1 : Idx - 2;
+			}
+		}
+#endif
+		for (; Idx - 1 >= Begin; Idx--)
+		{
+			if (Words[Idx - 1] != 0)
+			{
+				return Idx - 1;
+			}
+		}
+
+		return INDEX_NONE;
+	}
+
+	/* Returns the index of the last value in [Begin, End) other than a given one, or INDEX_NONE. Compares four values at a time with SSE2 where available. */
+	int32 FindLastMismatch(const uint32* Values, int32 Begin, int32 End, uint32 Value)
+	{
+		int32 Idx = End;
+#if INPUTBUFFER_SSE_EVENT_FLAGS
+		const __m128i Expected = _mm_set1_epi32((int32)Value);
+		for (; Idx - 4 >= Begin; Idx -= 4)
+		{
+			const __m128i Quad = _mm_loadu_si128((const __m128i*)(Values + Idx - 4));
+			if (_mm_movemask_epi8(_mm_cmpeq_epi32(Quad, Expected)) != 0xFFFF)
+			{
+				break; // Resolve the exact index below.
+			}
+		}
+#endif
+		for (; Idx - 1 >= Begin; Idx--)
+		{
+			if (Values[Idx - 1] != Value)
+			{
+				return Idx - 1;
+			}
+		}
+
+		return INDEX_NONE;
+	}
+}
+
+const uint32 FInputHistory::INVALID_EPOCH;
+
+FInputHistory::FInputHistory()
+	: Epoch(1)
+	, Head(0)
+	, Count(0)
+{
+}
+
+void FInputHistory::Reset(int32 InCapacity)
+{
+	InCapacity = FMath::Max(InCapacity, 0);
+
+	Events.SetNumZeroed(InCapacity);
+	TranslatedEvents.SetNumZeroed(InCapacity);
+	StartTimes.SetNumZeroed(InCapacity);
+	EndTimes.SetNumZeroed(InCapacity);
+	Epochs.Init(INVALID_EPOCH, InCapacity);
+
+	Head = 0;
+	Count = 0;
+}
+
+int32 FInputHistory::Push(const FInputBufferRecord& Record)
+{
+	if (Capacity() == 0)
+	{
+		return INDEX_NONE;
+	}
+
+	int32 Physical;
+	if (Count < Capacity())
+	{
+		Physical = Head + Count;
+		Physical = Physical < Capacity() ? Physical : Physical - Capacity();
+		Count++;
+	}
+	else
+	{
+		// Replace the oldest record.
+		Physical = Head;
+		Head = (Head + 1 < Capacity()) ? Head + 1 : 0;
+	}
+
+	Events[Physical] = Record.Events;
+	TranslatedEvents[Physical] = Record.TranslatedEvents;
+	StartTimes[Physical] = Record.StartTime;
+	EndTimes[Physical] = Record.EndTime;
+
+	Epochs[Physical] = Record.bValid ? Epoch : INVALID_EPOCH;
+
+	return Count - 1;
+}
+
+FInputBufferRecord FInputHistory::GetRecord(int32 Index) const
+{
+	const int32 Physical = ToPhysical(Index);
+	return FInputBufferRecord(StartTimes[Physical], EndTimes[Physical], Events[Physical], TranslatedEvents[Physical], Epochs[Physical] == Epoch);
+}
+
+void FInputHistory::SetLastEndTime(float EndTime)
+{
+	check(Count > 0);
+	EndTimes[ToPhysical(Count - 1)] = EndTime;
+}
+
+void FInputHistory::InvalidateAll()
+{
+	if (++Epoch == INVALID_EPOCH)
+	{
+		// Records stamped before the epoch wrapped around could become valid again, so stamp them explicitly once in a while.
+		Epoch++;
+		FMemory::Memzero(Epochs.GetData(), Epochs.Num() * sizeof(uint32));
+	}
+}
+
+void FInputHistory::Invalidate(int32 FirstIndex, int32 LastIndex)
+{
+	for (int32 Idx = FMath::Max(FirstIndex, 0); Idx <= LastIndex && Idx < Count; Idx++)
+	{
+		Epochs[ToPhysical(Idx)] = INVALID_EPOCH;
+	}
+}
+
+int32 FInputHistory::FindFirstInTimeWindow(float CurrTime, float TimeLimit) const
+{
+	if (TimeLimit == 0.f)
+	{
+		return 0;
+	}
+
+	// End times never decrease, so records within the time limit form a suffix of the history.
+	int32 Low = 0;
+	int32 High = Count;
+	while (Low < High)
+	{
+		const int32 Mid = Low + (High - Low) / 2;
+		if (CurrTime - GetEndTime(Mid) <= TimeLimit)
+		{
+			High = Mid;
+		}
+		else
+		{
+			Low = Mid + 1;
+		}
+	}
+
+	return Low;
+}
+
+template <typename FunctionType>
+void FInputHistory::ForEachPhysicalRangeReverse(int32 FirstIndex, FunctionType&& Function) const
+{
+	if (FirstIndex >= Count)
+	{
+		return;
+	}
+
+	const int32 Begin = ToPhysical(FirstIndex);
+	const int32 End = ToPhysical(Count - 1) + 1;
+	if (Begin < End)
+	{
+		Function(Begin, End);
+	}
+	else if (!Function(0, End)) // The range wraps around.
+	{
+		Function(Begin, Capacity());
+	}
+}
+
+int32 FInputHistory::FindFirstOfValidTrail() const
+{
+	int32 Result = 0;
+	ForEachPhysicalRangeReverse(0, [this, &Result](int32 Begin, int32 End)
+	{
+		const int32 Physical = InputHistory::FindLastMismatch(Epochs.GetData(), Begin, End, Epoch);
+		if (Physical != INDEX_NONE)
+		{
+			const int32 Index = Physical >= Head ? Physical - Head : Physical + Capacity() - Head;
+			Result = Index + 1;
+			return true;
+		}
+		return false;
+	});
+
+	return Result;
+}
+
+int32 FInputHistory::FindLastNonEmpty(int32 FirstIndex) const
+{
+	int32 Result = INDEX_NONE;
+	ForEachPhysicalRangeReverse(FirstIndex, [this, &Result](int32 Begin, int32 End)
+	{
+		const int32 NumWords = FInputEventFlags::NUM_WORDS;
+		const int32 Word = InputHistory::FindLastNonZeroWord((const uint64*)Events.GetData(), Begin * NumWords, End * NumWords);
+		if (Word != INDEX_NONE)
+		{
+			const int32 Physical = Word / NumWords;
+			Result = Physical >= Head ? Physical - Head : Physical + Capacity() - Head;
+			return true;
+		}
+		return false;
+	});
+
+	return Result;
+}
+
+int32 FInputHistory::GetSnapshotSize() const
+{
+	return sizeof(Epoch) + sizeof(Head) + sizeof(Count) + Capacity() * (2 * sizeof(FInputEventFlags) + 2 * sizeof(float) + sizeof(uint32));
+}
+
+void FInputHistory::SaveSnapshot(uint8* Data) const
+{
+	// Each column is contiguous, so it is copied with a single memcpy.
+	InputBufferSnapshot::Write(Data, &Epoch, 1);
+	InputBufferSnapshot::Write(Data, &Head, 1);
+	InputBufferSnapshot::Write(Data, &Count, 1);
+	InputBufferSnapshot::Write(Data, Events.GetData(), Capacity());
+	InputBufferSnapshot::Write(Data, TranslatedEvents.GetData(), Capacity());
+	InputBufferSnapshot::Write(Data, StartTimes.GetData(), Capacity());
+	InputBufferSnapshot::Write(Data, EndTimes.GetData(), Capacity());
+	InputBufferSnapshot::Write(Data, Epochs.GetData(), Capacity());
+}
+
+void FInputHistory::RestoreSnapshot(const uint8* Data)
+{
+	InputBufferSnapshot::Read(Data, &Epoch, 1);
+	InputBufferSnapshot::Read(Data, &Head, 1);
+	InputBufferSnapshot::Read(Data, &Count, 1);
+	InputBufferSnapshot::Read(Data, Events.GetData(), Capacity());
+	InputBufferSnapshot::Read(Data, TranslatedEvents.GetData(), Capacity());
+	InputBufferSnapshot::Read(Data, StartTimes.GetData(), Capacity());
+	InputBufferSnapshot::Read(Data, EndTimes.GetData(), Capacity());
+	InputBufferSnapshot::Read(Data, Epochs.GetData(), Capacity());
+}
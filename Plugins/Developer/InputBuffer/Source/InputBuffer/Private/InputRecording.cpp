@@ -0,0 +1,176 @@
+// Copyright 2018 Isaac Hsu.
+
+#include "InputRecording.h"
+
+#include "Serialization/Archive.h"
+
+//////////////////////////////////////////////////////////////////////////
+// FInputRecordingWriter
+
+FInputRecordingWriter::FInputRecordingWriter(FArchive& InArchive, const TArray<FName>& EventNames)
+	: Archive(InArchive)
+	, bHasFrame(false)
+	, FirstTime(0.f)
+	, LastTick(0)
+{
+	uint32 Magic = InputRecording::MAGIC;
+	uint32 Version = InputRecording::VERSION;
+	int32 NumWords = FInputEventFlags::NUM_WORDS;
+	int32 NumEvents = EventNames.Num();
+	Archive << Magic << Version << NumWords << NumEvents;
+
+	for (FName Name : EventNames)
+	{
+		FString NameString = Name.ToString();
+		Archive << NameString;
+	}
+}
+
+void FInputRecordingWriter::WriteFrame(const FInputEventFlags& Events, const FInputEventFlags& TranslatedEvents, float Time)
+{
+	if (!bHasFrame)
+	{
+		bHasFrame = true;
+		FirstTime = Time;
+	}
+
+	// Times are stored in microseconds from the first frame, so that deltas do not accumulate rounding errors.
+	const int64 Tick = FMath::Max<int64>((int64)((Time - FirstTime) * 1000000.0 + 0.5), LastTick);
+	const bool bChanged = Events != LastEvents || TranslatedEvents != LastTranslatedEvents;
+
+	WriteVarint(((uint64)(Tick - LastTick) << 1) | (bChanged ? 1 : 0));
+	LastTick = Tick;
+
+	if (bChanged)
+	{
+		WriteFlags(Events, LastEvents);
+		WriteFlags(TranslatedEvents, LastTranslatedEvents);
+		LastEvents = Events;
+		LastTranslatedEvents = TranslatedEvents;
+	}
+}
+
+void FInputRecordingWriter::WriteFlags(const FInputEventFlags& Flags, const FInputEventFlags& LastFlags)
+{
+	static_assert(FInputEventFlags::NUM_WORDS <= 64, "The mask of changed words must fit in a varint.");
+
+	uint64 WordMask = 0;
+	for (int32 Idx = 0; Idx < FInputEventFlags::NUM_WORDS; Idx++)
+	{
+		WordMask |= (uint64)(Flags.Words[Idx] != LastFlags.Words[Idx]) << Idx;
+	}
+
+	WriteVarint(WordMask);
+	for (int32 Idx = 0; Idx < FInputEventFlags::NUM_WORDS; Idx++)
+	{
+		if (WordMask & (1ULL << Idx))
+		{
+			WriteVarint(Flags.Words[Idx] ^ LastFlags.Words[Idx]);
+		}
+	}
+}
+
+void FInputRecordingWriter::WriteVarint(uint64 Value)
+{
+	uint8 Bytes[10];
+	int32 NumBytes = 0;
+	do
+	{
+		Bytes[NumBytes] = (uint8)(Value & 0x7F);
+		Value >>= 7;
+		Bytes[NumBytes++] |= Value ? 0x80 : 0;
+	}
+	while (Value);
+
+	Archive.Serialize(Bytes, NumBytes);
+}
+
+//////////////////////////////////////////////////////////////////////////
+// FInputRecordingReader
+
+FInputRecordingReader::FInputRecordingReader(FArchive& InArchive)
+	: Archive(InArchive)
+	, bValid(false)
+	, NumWords(0)
+	, LastTick(0)
+{
+	uint32 Magic = 0;
+	uint32 Version = 0;
+	int32 NumEvents = 0;
+	Archive << Magic << Version << NumWords << NumEvents;
+
+	if (Archive.IsError() || Magic != InputRecording::MAGIC || Version != InputRecording::VERSION || NumWords <= 0 || NumWords > 64 || NumEvents < 0 || NumEvents > NumWords * 64)
+	{
+		return;
+	}
+
+	EventNames.Reserve(NumEvents);
+	for (int32 Idx = 0; Idx < NumEvents; Idx++)
+	{
+		FString NameString;
+		Archive << NameString;
+		EventNames.Add(*NameString);
+	}
+
+	bValid = !Archive.IsError();
+}
+
+bool FInputRecordingReader::ReadFrame(FInputEventFlags& Events, FInputEventFlags& TranslatedEvents, double& Time)
+{
+	if (!bValid || Archive.AtEnd())
+	{
+		return false;
+	}
+
+	const uint64 Header = ReadVarint();
+	LastTick += (int64)(Header >> 1);
+
+	if (Header & 1)
+	{
+		ReadFlags(LastEvents);
+		ReadFlags(LastTranslatedEvents);
+	}
+
+	if (Archive.IsError())
+	{
+		bValid = false;
+		return false;
+	}
+
+	Events = LastEvents;
+	TranslatedEvents = LastTranslatedEvents;
+	Time = LastTick / 1000000.0;
+	return true;
+}
+
+void FInputRecordingReader::ReadFlags(FInputEventFlags& Flags)
+{
+	const uint64 WordMask = ReadVarint();
+	for (int32 Idx = 0; Idx < NumWords; Idx++)
+	{
+		if (WordMask & (1ULL << Idx))
+		{
+			const uint64 Delta = ReadVarint();
+			if (Idx < FInputEventFlags::NUM_WORDS)
+			{
+				Flags.Words[Idx] ^= Delta; // Events beyond the capacity of this build are dropped.
+			}
+		}
+	}
+}
+
+uint64 FInputRecordingReader::ReadVarint()
+{
+	uint64 Value = 0;
+	for (int32 Shift = 0; Shift < 64 && !Archive.IsError(); Shift += 7)
+	{
+		uint8 Byte = 0;
+		Archive.Serialize(&Byte, 1);
+		Value |= (uint64)(Byte & 0x7F) << Shift;
+		if ((Byte & 0x80) == 0)
+		{
+			break;
+		}
+	}
+	return Value;
+}
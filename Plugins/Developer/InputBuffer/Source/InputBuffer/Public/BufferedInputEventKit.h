@@ -2,6 +2,8 @@
 
 #pragma once
 
+#include "InputEventFlags.h"
+
 /* Holds common static functions for input events. Data members are not allowed here. */
 struct FBufferedInputEventKit
 {
@@ -25,4 +27,18 @@ struct FBufferedInputEventKit
 			return false;
 		}
 	}
+
+	/* Returns whether LHS has every bits set as RHS. */
+	template <int32 NumBits>
+	static FORCEINLINE bool HasEventFlags(const TInputEventFlags<NumBits>& Input, const TInputEventFlags<NumBits>& Match)
+	{
+		return Input.HasAll(Match);
+	}
+
+	/* Returns whether given bit flags has every bits set as matching one and has no bit set other than the matching and ignoring bits. */
+	template <int32 NumBits>
+	static FORCEINLINE bool CompareEventFlags(const TInputEventFlags<NumBits>& Input, const TInputEventFlags<NumBits>& Match, const TInputEventFlags<NumBits>& Ignore)
+	{
+		return Input.HasAll(Match) && Input.IsSubsetOf(Match | Ignore);
+	}
 };
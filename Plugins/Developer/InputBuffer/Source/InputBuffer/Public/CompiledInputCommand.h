@@ -0,0 +1,158 @@
+// Copyright 2018 Isaac Hsu.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "InputBufferRecord.h"
+
+class UInputCommand;
+
+/* An input command entry whose input events are resolved into bit flags. */
+struct FCompiledInputCommandEntry
+{
+	FCompiledInputCommandEntry()
+		: bIgnoreOthers(false)
+		, MinDuration(0.f)
+		, MaxDuration(0.f)
+		, MinInterval(0.f)
+		, MaxInterval(0.f)
+	{}
+
+	/* Bit flags of input events to match. */
+	FInputEventFlags MatchFlags;
+
+	/* Bit flags of input events to ignore. Includes the command-wide ones unless bIgnoreOthers is set. */
+	FInputEventFlags IgnoreFlags;
+
+	/* If true, ignore the presence of the other input events except the matching ones. */
+	bool bIgnoreOthers;
+
+	float MinDuration;
+	float MaxDuration;
+	float MinInterval;
+	float MaxInterval;
+
+	FORCEINLINE bool CheckDuration(float Duration) const
+	{
+		if (MaxDuration != 0.f && Duration > MaxDuration)
+		{
+			return false;
+		}
+		if (MinDuration != 0.f && Duration < MinDuration)
+		{
+			return false;
+		}
+
+		return true;
+	}
+
+	FORCEINLINE bool CheckInterval(float Interval) const
+	{
+		if (MinInterval != 0.f && Interval < MinInterval)
+		{
+			return false;
+		}
+		if (MaxInterval != 0.f && Interval > MaxInterval)
+		{
+			return false;
+		}
+
+		return true;
+	}
+};
+
+/* A range of entries in FCompiledInputCommand::Entries. */
+struct FCompiledInputCommandSequence
+{
+	FCompiledInputCommandSequence() : FirstEntry(0), NumEntries(0) {}
+
+	int32 FirstEntry;
+	int32 NumEntries;
+};
+
+/**
+* An input command compiled against the event table of an input buffer.
+* Only enabled sequences whose events are all known to the input buffer are kept, because the others can never match.
+**/
+struct INPUTBUFFER_API FCompiledInputCommand
+{
+	FCompiledInputCommand() : TimeLimit(0.f), bConsumeInput(false) {}
+
+	/* Time limit of valid input. Unused if zero. */
+	float TimeLimit;
+
+	/* Whether the input records used by a match are consumed on recognition. */
+	bool bConsumeInput;
+
+	/* Entries of all sequences, stored contiguously. */
+	TArray<FCompiledInputCommandEntry> Entries;
+
+	/* Sequences referring to ranges of Entries. */
+	TArray<FCompiledInputCommandSequence> Sequences;
+
+	/**
+	* Rebuilds the compiled data from a given command.
+	*
+	* @param Command The command to compile.
+	* @param EventIndexMap Bit indices of known input events.
+	*/
+	void Compile(const UInputCommand& Command, const TMap<FName, int32>& EventIndexMap);
+};
+
+enum class EInputCommandMatchResult : uint8
+{
+	Pending,
+	Matched,
+	Failed,
+};
+
+/**
+* Progress of matching a compiled sequence against input history in reverse chronological order.
+* Records are fed one at a time, so that many sequences can be matched in a single pass over the history.
+**/
+struct INPUTBUFFER_API FInputCommandMatchState
+{
+	FInputCommandMatchState() {}
+
+	explicit FInputCommandMatchState(int32 NumEntries)
+		: EntryIdx(NumEntries - 1)
+		, bRepeating(false)
+		, CurrEntryStartTime(0.f)
+		, CurrEntryEndTime(0.f)
+		, PrevEntryStartTime(0.f)
+		, PrevEntryEndTime(0.f)
+	{}
+
+	/* The index of the command entry to match next. */
+	int32 EntryIdx;
+
+	/* Are we trying to repeat the current entry? */
+	bool bRepeating;
+
+	/* The start time of the oldest matching record for the current entry. Used to check durations of entries. */
+	float CurrEntryStartTime;
+
+	/* The end time of the latest matching record for the current entry. Used to check durations of entries. */
+	float CurrEntryEndTime;
+
+	/* The start time of the oldest matching record for the previous entry. Used to check durations and interval of entries. */
+	float PrevEntryStartTime;
+
+	/* The end time of the latest matching record for the previous entry. Used to check durations of entries. */
+	float PrevEntryEndTime;
+
+	/**
+	* Matches the next older record.
+	*
+	* @param Entries Entries of the sequence being matched.
+	* @param TimeLimit Time limit of the command. Zero means no time limit.
+	* @param Record The record older than all the records fed so far.
+	* @param CurrTime The current time of the input buffer.
+	* @return Pending if older records are needed to decide.
+	*/
+	EInputCommandMatchResult Step(const FCompiledInputCommandEntry* Entries, float TimeLimit, const FInputBufferRecord& Record, float CurrTime);
+
+	/* Decides the result when there is no older record. */
+	EInputCommandMatchResult Finish(const FCompiledInputCommandEntry* Entries) const;
+};
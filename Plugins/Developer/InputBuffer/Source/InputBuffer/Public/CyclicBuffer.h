@@ -3,6 +3,8 @@
 #pragma once
 
 #include "Containers/Array.h"
+#include "Containers/ArrayView.h"
+#include "Templates/MemoryOps.h"
 
 template <typename ContainerType, typename ElementType>
 class TCyclicBufferIteratorBase
@@ -27,6 +29,9 @@ public:
 		return !(bool)*this;
 	}
 
+	FORCEINLINE friend bool operator==(const ThisClass& Lhs, const ThisClass& Rhs) { return &Lhs.Container == &Rhs.Container && Lhs.Index == Rhs.Index; }
+	FORCEINLINE friend bool operator!=(const ThisClass& Lhs, const ThisClass& Rhs) { return &Lhs.Container != &Rhs.Container || Lhs.Index != Rhs.Index; }
+
 	/** @name Element access */
 	//@{
 	ElementType& operator*() const
@@ -50,12 +55,7 @@ protected:
 		}
 		else
 		{
-			++Index;
-			int32 Limit = Container.Num() - 1;
-			if (Index > Limit && Container.TailIndex != Limit) // If we have reached the upper bound but not the tail
-			{
-				Index = 0;
-			}
+			Index = Container.WrapForward(Index + 1); // The tail is not reached, so this wraps around only if the buffer is full.
 		}
 	}
 
@@ -67,12 +67,7 @@ protected:
 		}
 		else
 		{
-			--Index;
-			int32 Limit = Container.Num() - 1;
-			if (Index < 0 && Container.TailIndex != Limit) // If we have reached the lower bound but not the head
-			{
-				Index = Limit;
-			}
+			Index = Container.WrapBackward(Index - 1); // The head is not reached, so this wraps around only if the buffer is full.
 		}
 	}
 
@@ -210,9 +205,14 @@ public:
 /**
 * Homogeneous cyclic buffer based on TArray. When a new element is added, the oldest one may be replaced if the buffer is full.
 *
+* If bPowerOfTwo is true, the capacity is rounded up to a power of two so that indices wrap around with a mask instead of a comparison.
+*
 * Caution: Must resize the buffer before adding elements to it.
+*
+* Note: The input history is stored by FInputHistory, not by this class. GetSpans, PushRange, CopyTo, bPowerOfTwo and
+* ranged-for are currently exercised only by the InputBuffer benchmark.
 */
-template <typename ElementType, typename Allocator = FDefaultAllocator>
+template <typename ElementType, typename Allocator = FDefaultAllocator, bool bPowerOfTwo = false>
 class TCyclicBuffer : private TArray<ElementType, Allocator>
 {
 	typedef TArray<ElementType, Allocator> Super;
@@ -236,16 +236,22 @@ public:
 
 public:
 
-	TCyclicBuffer() : TailIndex(INDEX_NONE) {}
+	TCyclicBuffer() : TailIndex(INDEX_NONE), IndexMask(INDEX_NONE) {}
 
 	using Super::Num;
 	using Super::Max;
 	using Super::GetData;
 
+	/* Returns the number of elements the buffer holds before it starts replacing the oldest ones. */
+	FORCEINLINE int32 Capacity() const
+	{
+		return bPowerOfTwo ? IndexMask + 1 : Super::ArrayMax;
+	}
+
 	/* Returns whether the buffer is full. */
 	FORCEINLINE bool IsFull() const
 	{
-		return Super::ArrayNum == Super::ArrayMax;
+		return Super::ArrayNum == Capacity();
 	}
 
 	/**
@@ -259,12 +265,7 @@ public:
 		ElementType* Result = nullptr;
 		if (Super::IsValidIndex(Index))
 		{
-			Index = InternalHeadIndex() + Index;
-			if (Index >= Super::ArrayNum)
-			{
-				Index -= Super::ArrayNum;
-			}
-			Result = GetData() + Index;
+			Result = GetData() + WrapForward(InternalHeadIndex() + Index);
 		}
 		return Result;
 	}
@@ -282,12 +283,7 @@ public:
 		const ElementType* Result = nullptr;
 		if (Super::IsValidIndex(Index))
 		{
-			Index = InternalHeadIndex() + Index;
-			if (Index >= Super::ArrayNum)
-			{
-				Index -= Super::ArrayNum;
-			}
-			Result = GetData() + Index;
+			Result = GetData() + WrapForward(InternalHeadIndex() + Index);
 		}
 		return Result;
 	}
@@ -303,12 +299,7 @@ public:
 		ElementType* Result = nullptr;
 		if (Super::IsValidIndex(IndexFromTheEnd))
 		{
-			int32 Index = TailIndex - IndexFromTheEnd;
-			if (Index < 0)
-			{
-				Index += Super::ArrayNum;
-			}
-			Result = GetData() + Index;
+			Result = GetData() + WrapBackward(TailIndex - IndexFromTheEnd);
 		}
 		return Result;
 	}
@@ -324,14 +315,9 @@ public:
 	FORCEINLINE const ElementType* Last(int32 IndexFromTheEnd = 0) const
 	{
 		const ElementType* Result = nullptr;
-		if (IndexFromTheEnd >= 0 && IndexFromTheEnd < Super::ArrayNum)
+		if (Super::IsValidIndex(IndexFromTheEnd))
 		{
-			int32 Index = TailIndex - IndexFromTheEnd;
-			if (Index < 0)
-			{
-				Index += Super::ArrayNum;
-			}
-			Result = GetData() + Index;
+			Result = GetData() + WrapBackward(TailIndex - IndexFromTheEnd);
 		}
 		return Result;
 	}
@@ -339,10 +325,15 @@ public:
 	/**
 	* Empties the array. It calls the destructors on held items if needed.
 	*
-	* @param Slack (Optional) The expected usage size after empty operation. Default is 0.
+	* @param Slack (Optional) The expected usage size after empty operation. Default is 0. Rounded up to a power of two if bPowerOfTwo is true.
 	*/
 	FORCEINLINE void Reset(int32 Slack = 0)
 	{
+		if (bPowerOfTwo)
+		{
+			Slack = Slack > 0 ? (int32)FMath::RoundUpToPowerOfTwo((uint32)Slack) : 0;
+			IndexMask = Slack - 1;
+		}
 		Super::Reset(Slack);
 		TailIndex = INDEX_NONE;
 	}
@@ -355,12 +346,12 @@ public:
 	*/
 	int32 Push(const ElementType& Item)
 	{
-		check(TailIndex < Super::ArrayMax);
-		if (Super::ArrayNum < Super::ArrayMax)
+		check(TailIndex < Capacity());
+		if (Super::ArrayNum < Capacity())
 		{
 			TailIndex = Super::Add(Item);
 		}
-		else if (Super::ArrayMax == 0)
+		else if (Capacity() == 0)
 		{
 			return INDEX_NONE;
 		}
@@ -374,15 +365,59 @@ public:
 		return TailIndex;
 	}
 
+	/**
+	* Pushes new items into the buffer in order, possibly replacing the oldest elements. Items are copied in at most three contiguous blocks.
+	*
+	* @param Items The items to add
+	* @param Count The number of items. Only the last Capacity() items are kept.
+	*/
+	void PushRange(const ElementType* Items, int32 Count)
+	{
+		const int32 Cap = Capacity();
+		if (Count <= 0 || Cap == 0)
+		{
+			return;
+		}
+		if (Count > Cap)
+		{
+			Items += Count - Cap;
+			Count = Cap;
+		}
+
+		// Fill free slots first.
+		const int32 NumFree = FMath::Min(Count, Cap - Super::ArrayNum);
+		if (NumFree > 0)
+		{
+			Super::Append(Items, NumFree);
+			TailIndex = Super::ArrayNum - 1;
+			Items += NumFree;
+			Count -= NumFree;
+		}
+
+		// Then replace the oldest elements, wrapping around at most once.
+		while (Count > 0)
+		{
+			const int32 HeadIndex = InternalHeadIndex();
+			const int32 NumCopied = FMath::Min(Count, Super::ArrayNum - HeadIndex);
+			CopyAssignItems(GetData() + HeadIndex, Items, NumCopied);
+			TailIndex = HeadIndex + NumCopied - 1;
+			Items += NumCopied;
+			Count -= NumCopied;
+		}
+	}
+
 	/**
 	* Adds a new item into the buffer, possibly extending the buffer if the buffer is full.
 	*
+	* Caution: A buffer with power-of-two capacity cannot be extended.
+	*
 	* @param Item The item to add
 	* @return Index to the new item
 	*/
 	int32 Add(const ElementType& Item)
 	{
 		check(TailIndex < Super::ArrayMax);
+		check(!bPowerOfTwo || Super::ArrayNum < Capacity());
 		if (Super::ArrayNum < Super::ArrayMax || TailIndex == Super::ArrayMax - 1)
 		{
 			TailIndex = Super::Add(Item);
@@ -396,6 +431,51 @@ public:
 		return TailIndex;
 	}
 
+	/**
+	* Returns the two contiguous ranges of memory which make up the contents of the buffer, from the oldest element to the latest one.
+	*
+	* @param OutFirst The older range. Empty only if the buffer is empty.
+	* @param OutSecond The newer range. Empty unless the contents wrap around the end of the memory.
+	*/
+	void GetSpans(TArrayView<ElementType>& OutFirst, TArrayView<ElementType>& OutSecond)
+	{
+		const int32 HeadIndex = Super::ArrayNum > 0 ? InternalHeadIndex() : 0;
+		OutFirst = TArrayView<ElementType>(GetData() + HeadIndex, Super::ArrayNum - HeadIndex);
+		OutSecond = TArrayView<ElementType>(GetData(), HeadIndex);
+	}
+
+	/* Const version of the above. */
+	void GetSpans(TArrayView<const ElementType>& OutFirst, TArrayView<const ElementType>& OutSecond) const
+	{
+		const int32 HeadIndex = Super::ArrayNum > 0 ? InternalHeadIndex() : 0;
+		OutFirst = TArrayView<const ElementType>(GetData() + HeadIndex, Super::ArrayNum - HeadIndex);
+		OutSecond = TArrayView<const ElementType>(GetData(), HeadIndex);
+	}
+
+	/**
+	* Copies the contents of the buffer in order, from the oldest element to the latest one.
+	*
+	* @param Dest An array of at least Num() constructed elements.
+	*/
+	void CopyTo(ElementType* Dest) const
+	{
+		TArrayView<const ElementType> FirstSpan, SecondSpan;
+		GetSpans(FirstSpan, SecondSpan);
+		CopyAssignItems(Dest, FirstSpan.GetData(), FirstSpan.Num());
+		CopyAssignItems(Dest + FirstSpan.Num(), SecondSpan.GetData(), SecondSpan.Num());
+	}
+
+	/* Replaces the contents of an array with the contents of the buffer in order. */
+	template <typename OtherAllocator>
+	void CopyTo(TArray<ElementType, OtherAllocator>& Dest) const
+	{
+		TArrayView<const ElementType> FirstSpan, SecondSpan;
+		GetSpans(FirstSpan, SecondSpan);
+		Dest.Reset(Super::ArrayNum);
+		Dest.Append(FirstSpan.GetData(), FirstSpan.Num());
+		Dest.Append(SecondSpan.GetData(), SecondSpan.Num());
+	}
+
 	/**
 	* Creates a iterator for the contents of this buffer
 	*
@@ -440,8 +520,29 @@ public:
 		return TConstReverseIterator(*this, StartIndex);
 	}
 
+	/**
+	* DO NOT USE DIRECTLY
+	* STL-like iterators to enable range-based for loop support.
+	*/
+	FORCEINLINE TIterator begin() { return TIterator(*this, 0); }
+	FORCEINLINE TConstIterator begin() const { return TConstIterator(*this, 0); }
+	FORCEINLINE TIterator end() { return TIterator(*this, Super::ArrayNum); }
+	FORCEINLINE TConstIterator end() const { return TConstIterator(*this, Super::ArrayNum); }
+
 protected:
 
+	/* Wraps around an index in [0, 2 * Num()) if the buffer is full. */
+	FORCEINLINE int32 WrapForward(int32 Index) const
+	{
+		return bPowerOfTwo ? (Index & IndexMask) : (Index < Super::ArrayNum ? Index : Index - Super::ArrayNum);
+	}
+
+	/* Wraps around an index in [-Num(), Num()) if the buffer is full. */
+	FORCEINLINE int32 WrapBackward(int32 Index) const
+	{
+		return bPowerOfTwo ? (Index & IndexMask) : (Index >= 0 ? Index : Index + Super::ArrayNum);
+	}
+
 	/* Returns the index of the first element if available. Otherwise, returns -1. */
 	int32 GetHeadIndex() const
 	{
@@ -470,4 +571,11 @@ protected:
 
 	/* The index of the last element. */
 	int32 TailIndex;
+
+	/* Capacity minus one. Only used if bPowerOfTwo is true. */
+	int32 IndexMask;
 };
+
+/* Cyclic buffer whose capacity is a power of two. */
+template <typename ElementType, typename Allocator = FDefaultAllocator>
+using TPowerOfTwoCyclicBuffer = TCyclicBuffer<ElementType, Allocator, true>;
@@ -0,0 +1,52 @@
+// Copyright 2018 Isaac Hsu.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FCompiledInputBufferSchema;
+class UCanvas;
+class UInputBufferComponent;
+
+/**
+* Draws the input history of an input buffer onto a canvas as one lane per input event over time, straight from event flags.
+*
+* Event labels are cached when the schema of the input buffer changes, so drawing a frame does not allocate.
+**/
+class INPUTBUFFER_API FInputBufferDebugTimeline
+{
+public:
+
+	FInputBufferDebugTimeline();
+
+	/**
+	* Draws the timeline of an input buffer.
+	*
+	* @param X The left of the timeline.
+	* @param Y The top of the timeline.
+	* @return The height of the drawn timeline.
+	*/
+	float Draw(UCanvas* Canvas, const UInputBufferComponent& InputBuffer, float X, float Y);
+
+public:
+
+	/* The time span of the timeline in seconds, ending at the latest input. */
+	float Duration;
+
+	/* The width of the lanes in pixels, excluding labels. */
+	float Width;
+
+protected:
+
+	void CacheLabels(UCanvas* Canvas, const FCompiledInputBufferSchema& Schema);
+
+protected:
+
+	/* The schema the labels were cached for. */
+	const FCompiledInputBufferSchema* CachedSchema;
+
+	TArray<FText> Labels;
+
+	float LabelWidth;
+	float LaneHeight;
+};
@@ -0,0 +1,43 @@
+// Copyright 2018 Isaac Hsu.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "InputEventFlags.h"
+
+/* Stored in input buffers to represent the same input status over one or several frames. */
+struct FInputBufferRecord
+{
+	FInputBufferRecord()
+		: bValid(false)
+		, StartTime(0.f)
+		, EndTime(0.f)
+	{}
+
+	FInputBufferRecord(float InStarTime, float InEndTime, const FInputEventFlags& InEvents, const FInputEventFlags& InTranslatedEvents, bool bInValid = true)
+		: bValid(bInValid)
+		, StartTime(InStarTime)
+		, EndTime(InEndTime)
+		, Events(InEvents)
+		, TranslatedEvents(InTranslatedEvents)
+	{}
+
+	/** Whether this record is valid. */
+	bool bValid;
+
+	/** Time when we start to record it. */
+	float StartTime;
+
+	/** Time when we stop recording it. */
+	float EndTime;
+
+	/** Bit flags of input events. */
+	FInputEventFlags Events;
+
+	/** Input events that are translated from. */
+	FInputEventFlags TranslatedEvents;
+
+	/** Input event capacity = the number of bits of event flags. */
+	static const int32 MAX_EVENTS = FInputEventFlags::NUM_BITS;
+};
@@ -0,0 +1,28 @@
+// Copyright 2018 Isaac Hsu.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+* Helpers to copy raw state into and out of snapshot buffers, used for saving and restoring the input buffer e.g. for rollback.
+* Snapshots are plain bytes without alignment, so they are only valid for the layout they were taken with.
+**/
+namespace InputBufferSnapshot
+{
+	/* Copies Num values to a snapshot buffer and advances the buffer past them. */
+	template <typename T>
+	FORCEINLINE void Write(uint8*& Data, const T* Values, int32 Num)
+	{
+		FMemory::Memcpy(Data, Values, Num * sizeof(T));
+		Data += Num * sizeof(T);
+	}
+
+	/* Copies Num values from a snapshot buffer and advances the buffer past them. */
+	template <typename T>
+	FORCEINLINE void Read(const uint8*& Data, T* Values, int32 Num)
+	{
+		FMemory::Memcpy(Values, Data, Num * sizeof(T));
+		Data += Num * sizeof(T);
+	}
+}
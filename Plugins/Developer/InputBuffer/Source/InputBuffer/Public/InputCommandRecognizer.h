@@ -0,0 +1,143 @@
+// Copyright 2018 Isaac Hsu.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "CompiledInputCommand.h"
+#include "InputBufferRecord.h"
+
+/**
+* A partial match of a compiled sequence, advanced forward in time.
+*
+* A thread is either in the run of consecutive records matching an entry, or in the gap of skippable records before the run of an entry.
+* A thread waiting for the entry after the last one is in the trailing gap of a complete match.
+**/
+struct FInputCommandThread
+{
+	/* The entry whose run the thread is in or waiting for. */
+	int32 EntryIdx;
+
+	/* Whether the latest record belongs to the run of EntryIdx. */
+	bool bInRun;
+
+	/* The serial of the first record of the current run if bInRun is true, or of the last record of the previous run. Identifies equivalent threads. */
+	int64 MarkSerial;
+
+	/* The serials of the first and last records matching the first entry. */
+	int64 FirstStartSerial;
+	int64 FirstEndSerial;
+
+	/* The start and end time of the records matching the first entry. */
+	float FirstStartTime;
+	float FirstEndTime;
+
+	/* The start and end time of the current or previous run. */
+	float RunStartTime;
+	float RunEndTime;
+};
+
+/**
+* Recognizes compiled commands incrementally, one record at a time, as records are pushed into an input buffer.
+*
+* The result after each record is the same as matching the whole history in reverse chronological order with FInputCommandMatchState,
+* so "does command X match now" becomes a constant-time lookup.
+**/
+class INPUTBUFFER_API FInputCommandRecognizer
+{
+public:
+
+	/* Maximal number of partial matches kept per sequence. The ones with the oldest input are dropped first. */
+	static const int32 MAX_THREADS_PER_SEQUENCE = 16;
+
+	FInputCommandRecognizer();
+
+	/* Replaces the recognized commands. Clears all progress. */
+	void SetCommands(TArray<FCompiledInputCommand>&& InCommands);
+
+	/* Clears all progress, e.g. when the input history is cleared or invalidated. */
+	void ResetProgress();
+
+	/**
+	* Advances all the commands with a newly pushed record.
+	*
+	* @param Record The pushed record.
+	* @param NumRetained The number of records in the input buffer, including the pushed one.
+	* @param OldestRecord The oldest record in the input buffer. Used when older records have been overwritten.
+	*/
+	void PushRecord(const FInputBufferRecord& Record, int32 NumRetained, const FInputBufferRecord& OldestRecord);
+
+	/* Updates all the commands when the last pushed record is prolonged. */
+	void ExtendRecord(const FInputBufferRecord& Record);
+
+	/**
+	* Forgets records older than the latest ones, e.g. when records are consumed by a matched command.
+	*
+	* @param NumRemaining The number of the latest records which can still take part in a match.
+	* @param OldestRemaining The oldest of those records. Unused if NumRemaining is zero.
+	*/
+	void DiscardOlderRecords(int32 NumRemaining, const FInputBufferRecord& OldestRemaining);
+
+	/**
+	* Decides which commands match at the given time.
+	*
+	* @return Whether any command starts to match.
+	*/
+	bool Evaluate(float CurrTime);
+
+	/* Returns the number of recognized commands. */
+	int32 NumCommands() const { return Commands.Num(); }
+
+	/* Returns whether a command matched at the last evaluation. */
+	bool IsMatched(int32 CommandIdx) const { return Matched[CommandIdx]; }
+
+	/* Returns whether a command started to match at the last evaluation. */
+	bool IsNewlyMatched(int32 CommandIdx) const { return NewlyMatched[CommandIdx]; }
+
+	/* Returns the number of bytes needed by a snapshot of the progress. Depends only on the recognized commands. */
+	int32 GetSnapshotSize() const;
+
+	/* Copies all progress to a buffer of GetSnapshotSize() bytes. */
+	void SaveSnapshot(uint8* Data) const;
+
+	/* Restores progress from a snapshot taken with the same commands. Does not allocate. */
+	void RestoreSnapshot(const uint8* Data);
+
+protected:
+
+	struct FSequence
+	{
+		int32 CommandIdx;
+		int32 FirstEntry;
+		int32 NumEntries;
+		int32 NumThreads;
+	};
+
+	void AdvanceSequence(int32 SequenceIdx, const FInputBufferRecord& Record, int32 NumRetained, const FInputBufferRecord& OldestRecord);
+
+	bool EvaluateSequence(int32 SequenceIdx, float CurrTime);
+
+	FORCEINLINE FInputCommandThread* GetThreads(int32 SequenceIdx)
+	{
+		return Threads.GetData() + SequenceIdx * MAX_THREADS_PER_SEQUENCE;
+	}
+
+protected:
+
+	TArray<FCompiledInputCommand> Commands;
+
+	TArray<FSequence> Sequences;
+
+	/* MAX_THREADS_PER_SEQUENCE slots per sequence. */
+	TArray<FInputCommandThread> Threads;
+
+	TBitArray<> Matched;
+	TBitArray<> NewlyMatched;
+
+	/* The serial of the last pushed record. INDEX_NONE if there is no record. */
+	int64 LastSerial;
+
+	/* Events and validity of the last pushed record. */
+	FInputEventFlags LastEvents;
+	bool bLastValid;
+};
@@ -0,0 +1,179 @@
+// Copyright 2018 Isaac Hsu.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "CompiledInputCommand.h"
+#include "InputBufferRecord.h"
+
+/**
+* Matches a set of compiled commands against input history in reverse chronological order, in a single pass.
+*
+* Sequences of all the commands are merged into a trie of their entries, last entry first, so that sequences ending with the same entries
+* under the same time limit share nodes. Each distinct event test of the entries is evaluated at most once per record, and each node is advanced
+* at most once per record, so the work per record depends on the number of distinct entries rather than on the number of sequences.
+*
+* The result of each command is the same as matching each of its sequences with FInputCommandMatchState.
+**/
+class INPUTBUFFER_API FInputCommandSetMatcher
+{
+public:
+
+	FInputCommandSetMatcher();
+
+	/* Removes all the commands. */
+	void Reset();
+
+	/* Adds a command with a lower priority than the ones added before. Null commands never match. The entries of the command must outlive the match. */
+	void AddCommand(const FCompiledInputCommand* Command);
+
+	/* Starts a new match. Commands without any sequence are failed at once. */
+	void Begin();
+
+	/**
+	* Matches the next older record.
+	*
+	* @param Record The record older than all the records fed so far.
+	* @param CurrTime The current time of the input buffer.
+	* @return Whether older records are needed to decide any command.
+	*/
+	bool Step(const FInputBufferRecord& Record, float CurrTime);
+
+	/* Decides the remaining commands when there is no older record. */
+	void Finish();
+
+	/* Returns the matched command with the highest priority once every command prior to it has failed, or INDEX_NONE. */
+	int32 FindFirstMatched();
+
+	/* Returns the result of each command. */
+	const TArray<EInputCommandMatchResult, TInlineAllocator<64>>& GetResults() const { return Results; }
+
+	/* Returns the number of nodes in the automaton. */
+	int32 NumNodes() const { return Nodes.Num(); }
+
+	/* Returns the number of distinct event tests in the automaton. */
+	int32 NumTests() const { return Tests.Num(); }
+
+	/* Returns the largest number of event tests and node advances done for a single record since Begin. */
+	int32 GetMaxStepWork() const { return MaxStepWork; }
+
+protected:
+
+	/* Event flags tested by entries. Shared by all the entries testing the same flags. */
+	struct FTest
+	{
+		FInputEventFlags MatchFlags;
+		FInputEventFlags IgnoreFlags;
+		bool bIgnoreOthers;
+	};
+
+	/* An entry shared by sequences which end with the same entries. */
+	struct FNode
+	{
+		const FCompiledInputCommandEntry* Entry;
+		float TimeLimit;
+		int32 TestIdx;
+
+		/* The node of the next entry, or INDEX_NONE if this is the last entry. */
+		int32 Parent;
+
+		/* Nodes of the previous entries. */
+		TArray<int32, TInlineAllocator<4>> Children;
+
+		/* Sequences whose first entry is this one. */
+		TArray<int32, TInlineAllocator<4>> Terminals;
+
+		/* The number of sequences passing through this node. */
+		int32 NumSequences;
+	};
+
+	/* A range of Sequences. */
+	struct FCommand
+	{
+		int32 FirstSequence;
+		int32 NumSequences;
+	};
+
+	struct FSequence
+	{
+		int32 CommandIdx;
+
+		/* The node of the first entry, or INDEX_NONE if the sequence has no entry. */
+		int32 Terminal;
+	};
+
+	/* Progress of matching at a node. There is at most one token per node, since tokens only move from a node to its children. */
+	struct FToken
+	{
+		int32 NodeIdx;
+		bool bRepeating;
+		float CurrEntryStartTime;
+		float CurrEntryEndTime;
+		float PrevEntryStartTime;
+		float PrevEntryEndTime;
+	};
+
+	/* Returns the node of an entry under a given parent, adding it if there is none. */
+	int32 FindOrAddNode(int32 Parent, const FCompiledInputCommandEntry& Entry, float TimeLimit);
+
+	/* Returns the test of an entry, adding it if there is none. */
+	int32 FindOrAddTest(const FCompiledInputCommandEntry& Entry);
+
+	/* Advances a token with a record. Forks into the worklist when moving to several children. Returns whether the token is kept. */
+	bool StepToken(FToken& Token, const FInputBufferRecord& Record, float CurrTime, int32& Work);
+
+	/* Decides the sequences of a token when there is no older record. */
+	void FinishToken(const FToken& Token);
+
+	/* Returns the result of a test against the given record. Evaluates it once per record. */
+	uint8 GetTestResult(int32 TestIdx, const FInputBufferRecord& Record, int32& Work);
+
+	/* Records the result of a sequence. Decided sequences are ignored. */
+	void DecideSequence(int32 SequenceIdx, EInputCommandMatchResult Result);
+
+	/* Fails every undecided sequence passing through a node. */
+	void FailSubtree(int32 NodeIdx);
+
+protected:
+
+	static const uint8 TEST_EVALUATED = 1;
+	static const uint8 TEST_MATCHED = 2;
+	static const uint8 TEST_SKIPPABLE = 4;
+
+	TArray<FTest> Tests;
+
+	TArray<FNode> Nodes;
+
+	/* Nodes of the last entries. */
+	TArray<int32> Roots;
+
+	TArray<FCommand, TInlineAllocator<64>> Commands;
+
+	/* Sequences of all the commands, in the order of commands. */
+	TArray<FSequence> Sequences;
+
+	TArray<EInputCommandMatchResult, TInlineAllocator<64>> Results;
+
+	/* The number of undecided sequences per command. */
+	TArray<int32, TInlineAllocator<64>> PendingSequences;
+
+	/* The number of undecided sequences passing through each node. Tokens at nodes without any are dropped. */
+	TArray<int32> LiveSequences;
+
+	TBitArray<> DecidedSequences;
+
+	TArray<FToken> Tokens;
+	TArray<FToken> NextTokens;
+
+	/* Tokens forked while advancing the current record. */
+	TArray<FToken> Worklist;
+
+	/* Test results of the current record. */
+	TArray<uint8> TestResults;
+
+	/* Commands before this index are known to have failed. */
+	int32 FirstUndecided;
+
+	int32 MaxStepWork;
+};
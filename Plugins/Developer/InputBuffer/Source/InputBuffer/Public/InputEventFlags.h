@@ -0,0 +1,212 @@
+// Copyright 2018 Isaac Hsu.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/* Input event capacity. Set in InputBuffer.Build.cs; must be a multiple of 64. */
+#ifndef INPUTBUFFER_MAX_EVENTS
+#define INPUTBUFFER_MAX_EVENTS 64
+#endif
+
+#if PLATFORM_ENABLE_VECTORINTRINSICS && PLATFORM_CPU_X86_FAMILY
+#include <emmintrin.h>
+#define INPUTBUFFER_SSE_EVENT_FLAGS 1
+#else
+#define INPUTBUFFER_SSE_EVENT_FLAGS 0
+#endif
+
+/**
+* Fixed-width bit flags of input events.
+*
+* With a single word, every operation compiles down to plain uint64 arithmetic.
+* Wider flags compare 128 bits at a time with SSE2 where available.
+**/
+template <int32 NumBits>
+struct TInputEventFlags
+{
+	static_assert(NumBits > 0 && NumBits % 64 == 0, "The number of event bits must be a positive multiple of 64.");
+
+	static const int32 NUM_BITS = NumBits;
+	static const int32 NUM_WORDS = NumBits / 64;
+
+	uint64 Words[NUM_WORDS];
+
+	FORCEINLINE TInputEventFlags()
+	{
+		for (int32 Idx = 0; Idx < NUM_WORDS; Idx++)
+		{
+			Words[Idx] = 0;
+		}
+	}
+
+	/* Returns flags with a single bit set. */
+	static FORCEINLINE TInputEventFlags FromBit(int32 Index)
+	{
+		TInputEventFlags Result;
+		Result.SetBit(Index);
+		return Result;
+	}
+
+	FORCEINLINE void SetBit(int32 Index)
+	{
+		checkSlow(Index >= 0 && Index < NUM_BITS);
+		Words[Index >> 6] |= (1ULL << (Index & 63));
+	}
+
+	FORCEINLINE void ClearBit(int32 Index)
+	{
+		checkSlow(Index >= 0 && Index < NUM_BITS);
+		Words[Index >> 6] &= ~(1ULL << (Index & 63));
+	}
+
+	FORCEINLINE bool TestBit(int32 Index) const
+	{
+		checkSlow(Index >= 0 && Index < NUM_BITS);
+		return (Words[Index >> 6] & (1ULL << (Index & 63))) != 0;
+	}
+
+	FORCEINLINE bool IsZero() const
+	{
+		uint64 Any = 0;
+		for (int32 Idx = 0; Idx < NUM_WORDS; Idx++)
+		{
+			Any |= Words[Idx];
+		}
+		return Any == 0;
+	}
+
+	/* Returns whether every bit of Match is set. */
+	FORCEINLINE bool HasAll(const TInputEventFlags& Match) const
+	{
+#if INPUTBUFFER_SSE_EVENT_FLAGS
+		if (NUM_WORDS % 2 == 0)
+		{
+			int32 Mask = 0xFFFF;
+			for (int32 Idx = 0; Idx < NUM_WORDS; Idx += 2)
+			{
+				const __m128i M = _mm_loadu_si128((const __m128i*)(Match.Words + Idx));
+				const __m128i I = _mm_loadu_si128((const __m128i*)(Words + Idx));
+				Mask &= _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(I, M), M));
+			}
+			return Mask == 0xFFFF;
+		}
+#endif
+		uint64 Missing = 0;
+		for (int32 Idx = 0; Idx < NUM_WORDS; Idx++)
+		{
+			Missing |= Match.Words[Idx] & ~Words[Idx];
+		}
+		return Missing == 0;
+	}
+
+	/* Returns whether no bit is set other than the bits of Set. */
+	FORCEINLINE bool IsSubsetOf(const TInputEventFlags& Set) const
+	{
+#if INPUTBUFFER_SSE_EVENT_FLAGS
+		if (NUM_WORDS % 2 == 0)
+		{
+			const __m128i Zero = _mm_setzero_si128();
+			int32 Mask = 0xFFFF;
+			for (int32 Idx = 0; Idx < NUM_WORDS; Idx += 2)
+			{
+				const __m128i S = _mm_loadu_si128((const __m128i*)(Set.Words + Idx));
+				const __m128i I = _mm_loadu_si128((const __m128i*)(Words + Idx));
+				Mask &= _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_andnot_si128(S, I), Zero));
+			}
+			return Mask == 0xFFFF;
+		}
+#endif
+		uint64 Extra = 0;
+		for (int32 Idx = 0; Idx < NUM_WORDS; Idx++)
+		{
+			Extra |= Words[Idx] & ~Set.Words[Idx];
+		}
+		return Extra == 0;
+	}
+
+	/* Returns the number of set bits. */
+	FORCEINLINE int32 CountBits() const
+	{
+		int32 Count = 0;
+		for (int32 Idx = 0; Idx < NUM_WORDS; Idx++)
+		{
+			Count += FPlatformMath::CountBits(Words[Idx]);
+		}
+		return Count;
+	}
+
+	/* Calls a function with the index of each set bit in ascending order. */
+	template <typename FunctionType>
+	FORCEINLINE void ForEachSetBit(FunctionType&& Function) const
+	{
+		for (int32 Idx = 0; Idx < NUM_WORDS; Idx++)
+		{
+			uint64 Word = Words[Idx];
+			while (Word != 0)
+			{
+				Function(Idx * 64 + (int32)FPlatformMath::CountTrailingZeros64(Word));
+				Word &= Word - 1;
+			}
+		}
+	}
+
+	FORCEINLINE TInputEventFlags& operator&=(const TInputEventFlags& RHS)
+	{
+		for (int32 Idx = 0; Idx < NUM_WORDS; Idx++)
+		{
+			Words[Idx] &= RHS.Words[Idx];
+		}
+		return *this;
+	}
+
+	FORCEINLINE TInputEventFlags& operator|=(const TInputEventFlags& RHS)
+	{
+		for (int32 Idx = 0; Idx < NUM_WORDS; Idx++)
+		{
+			Words[Idx] |= RHS.Words[Idx];
+		}
+		return *this;
+	}
+
+	FORCEINLINE TInputEventFlags& operator^=(const TInputEventFlags& RHS)
+	{
+		for (int32 Idx = 0; Idx < NUM_WORDS; Idx++)
+		{
+			Words[Idx] ^= RHS.Words[Idx];
+		}
+		return *this;
+	}
+
+	FORCEINLINE TInputEventFlags operator~() const
+	{
+		TInputEventFlags Result;
+		for (int32 Idx = 0; Idx < NUM_WORDS; Idx++)
+		{
+			Result.Words[Idx] = ~Words[Idx];
+		}
+		return Result;
+	}
+
+	FORCEINLINE TInputEventFlags operator&(const TInputEventFlags& RHS) const { return TInputEventFlags(*this) &= RHS; }
+	FORCEINLINE TInputEventFlags operator|(const TInputEventFlags& RHS) const { return TInputEventFlags(*this) |= RHS; }
+	FORCEINLINE TInputEventFlags operator^(const TInputEventFlags& RHS) const { return TInputEventFlags(*this) ^= RHS; }
+
+	FORCEINLINE bool operator==(const TInputEventFlags& RHS) const
+	{
+		uint64 Diff = 0;
+		for (int32 Idx = 0; Idx < NUM_WORDS; Idx++)
+		{
+			Diff |= Words[Idx] ^ RHS.Words[Idx];
+		}
+		return Diff == 0;
+	}
+
+	FORCEINLINE bool operator!=(const TInputEventFlags& RHS) const
+	{
+		return !(*this == RHS);
+	}
+};
+
+/* Bit flags of input events with the capacity configured for this build. */
+typedef TInputEventFlags<INPUTBUFFER_MAX_EVENTS> FInputEventFlags;
@@ -0,0 +1,116 @@
+// Copyright 2018 Isaac Hsu.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "InputBufferRecord.h"
+
+/**
+* Input history stored as a structure of arrays in a fixed-capacity ring. When a new record is pushed into a full history, the oldest one is replaced.
+*
+* Each field of the records lives in its own contiguous array, so that queries touch only the fields they need:
+* time windows are found by binary search on end times, which never decrease, and empty records are skipped by scanning event flags alone.
+*
+* A record is valid if it is stamped with the current epoch, so the whole history is invalidated by bumping the epoch.
+*
+* Records are addressed by their logical index, where 0 is the oldest record.
+**/
+class INPUTBUFFER_API FInputHistory
+{
+public:
+
+	/* Stamp of records invalidated individually. Never used as the current epoch. */
+	static const uint32 INVALID_EPOCH = 0;
+
+	FInputHistory();
+
+	/* Removes all records and sets the capacity of the history. */
+	void Reset(int32 InCapacity);
+
+	FORCEINLINE int32 Num() const { return Count; }
+	FORCEINLINE int32 Capacity() const { return EndTimes.Num(); }
+	FORCEINLINE bool IsFull() const { return Count == Capacity(); }
+
+	/**
+	* Pushes a new record, replacing the oldest one if the history is full.
+	*
+	* @return The logical index of the new record, or INDEX_NONE if the capacity is zero.
+	*/
+	int32 Push(const FInputBufferRecord& Record);
+
+	/* Returns a copy of a record. */
+	FInputBufferRecord GetRecord(int32 Index) const;
+
+	FORCEINLINE float GetStartTime(int32 Index) const { return StartTimes[ToPhysical(Index)]; }
+	FORCEINLINE float GetEndTime(int32 Index) const { return EndTimes[ToPhysical(Index)]; }
+	FORCEINLINE const FInputEventFlags& GetEvents(int32 Index) const { return Events[ToPhysical(Index)]; }
+	FORCEINLINE const FInputEventFlags& GetTranslatedEvents(int32 Index) const { return TranslatedEvents[ToPhysical(Index)]; }
+
+	FORCEINLINE bool IsValid(int32 Index) const { return Epochs[ToPhysical(Index)] == Epoch; }
+
+	/* Prolongs the last record. */
+	void SetLastEndTime(float EndTime);
+
+	/* Marks all the records invalid in constant time. */
+	void InvalidateAll();
+
+	/* Marks the records in [FirstIndex, LastIndex] invalid, e.g. when they are consumed by a matched command. */
+	void Invalidate(int32 FirstIndex, int32 LastIndex);
+
+	/**
+	* Binary searches for the oldest record within a time limit.
+	*
+	* @param CurrTime The current time of the input buffer.
+	* @param TimeLimit Records older than this are excluded. Zero means no time limit.
+	* @return The logical index of the oldest record whose end time is within the time limit, or Num() if there is none.
+	*/
+	int32 FindFirstInTimeWindow(float CurrTime, float TimeLimit) const;
+
+	/* Returns the logical index of the oldest record of the trailing run of valid records, or Num() if the last record is invalid. */
+	int32 FindFirstOfValidTrail() const;
+
+	/* Returns the logical index of the latest record with any event, searching no older than FirstIndex. Returns INDEX_NONE if there is none. */
+	int32 FindLastNonEmpty(int32 FirstIndex = 0) const;
+
+	/* Returns the number of bytes needed by a snapshot of the history. Depends only on the capacity. */
+	int32 GetSnapshotSize() const;
+
+	/* Copies the whole state of the history to a buffer of GetSnapshotSize() bytes. */
+	void SaveSnapshot(uint8* Data) const;
+
+	/* Restores the state of the history from a snapshot taken with the same capacity. Does not allocate. */
+	void RestoreSnapshot(const uint8* Data);
+
+protected:
+
+	FORCEINLINE int32 ToPhysical(int32 Index) const
+	{
+		checkSlow(Index >= 0 && Index < Count);
+		const int32 Physical = Head + Index;
+		return Physical < Capacity() ? Physical : Physical - Capacity();
+	}
+
+	/* Calls a function with the physical ranges [Begin, End) covering the logical range [FirstIndex, Num()), latest range first. Stops if the function returns true. */
+	template <typename FunctionType>
+	void ForEachPhysicalRangeReverse(int32 FirstIndex, FunctionType&& Function) const;
+
+protected:
+
+	TArray<FInputEventFlags> Events;
+	TArray<FInputEventFlags> TranslatedEvents;
+	TArray<float> StartTimes;
+	TArray<float> EndTimes;
+
+	/* The epoch in which each record was written, or INVALID_EPOCH. */
+	TArray<uint32> Epochs;
+
+	/* Records stamped with other epochs are invalid. */
+	uint32 Epoch;
+
+	/* The physical index of the oldest record. */
+	int32 Head;
+
+	/* The number of records. */
+	int32 Count;
+};
@@ -0,0 +1,104 @@
+// Copyright 2018 Isaac Hsu.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "InputEventFlags.h"
+
+/**
+* Compact binary recording of buffered input.
+*
+* A recording starts with a header holding the names of the recorded events, followed by one frame per input buffered.
+* Each frame starts with a varint of the time delta from the previous frame in microseconds, shifted left by one bit.
+* If the low bit is set, the events differ from the previous frame and the frame goes on with both event flags and translated event flags,
+* each encoded as a varint mask of the words that changed followed by a varint of each changed word XOR the previous one.
+**/
+namespace InputRecording
+{
+	static const uint32 MAGIC = 0x43524249; // IBRC
+	static const uint32 VERSION = 1;
+}
+
+/* Writes input frames to an archive. */
+class INPUTBUFFER_API FInputRecordingWriter
+{
+public:
+
+	/**
+	* Writes the header of a recording.
+	*
+	* @param InArchive The archive to write to. Must outlive the writer.
+	* @param EventNames Names of input events, in the order of event bits.
+	*/
+	FInputRecordingWriter(FArchive& InArchive, const TArray<FName>& EventNames);
+
+	/* Writes a frame of input at a given time. Time must not decrease between frames. */
+	void WriteFrame(const FInputEventFlags& Events, const FInputEventFlags& TranslatedEvents, float Time);
+
+protected:
+
+	void WriteFlags(const FInputEventFlags& Flags, const FInputEventFlags& LastFlags);
+
+	void WriteVarint(uint64 Value);
+
+protected:
+
+	FArchive& Archive;
+
+	bool bHasFrame;
+	float FirstTime;
+	int64 LastTick;
+
+	FInputEventFlags LastEvents;
+	FInputEventFlags LastTranslatedEvents;
+};
+
+/* Reads input frames from an archive written by FInputRecordingWriter. */
+class INPUTBUFFER_API FInputRecordingReader
+{
+public:
+
+	/**
+	* Reads the header of a recording.
+	*
+	* @param InArchive The archive to read from. Must outlive the reader.
+	*/
+	explicit FInputRecordingReader(FArchive& InArchive);
+
+	/* Returns whether the header is valid. */
+	bool IsValid() const { return bValid; }
+
+	/* Returns names of recorded input events, in the order of event bits. */
+	const TArray<FName>& GetEventNames() const { return EventNames; }
+
+	/**
+	* Reads the next frame.
+	*
+	* @param Time Time of the frame relative to the first frame.
+	* @return False if there is no more frame.
+	*/
+	bool ReadFrame(FInputEventFlags& Events, FInputEventFlags& TranslatedEvents, double& Time);
+
+protected:
+
+	void ReadFlags(FInputEventFlags& Flags);
+
+	uint64 ReadVarint();
+
+protected:
+
+	FArchive& Archive;
+
+	bool bValid;
+
+	/* The number of 64-bit words of event flags in the recording. */
+	int32 NumWords;
+
+	TArray<FName> EventNames;
+
+	int64 LastTick;
+
+	FInputEventFlags LastEvents;
+	FInputEventFlags LastTranslatedEvents;
+};
@@ -29,6 +29,7 @@ public class InputBufferEditor : ModuleRules
             "InputCore",
             "UnrealEd",
             "AssetTools",
+            "Json",
         });
 				
 		// ... add any modules that your module loads dynamically here ...
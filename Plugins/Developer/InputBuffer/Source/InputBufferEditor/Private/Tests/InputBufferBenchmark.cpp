@@ -0,0 +1,382 @@
+// Copyright 2018 Isaac Hsu.
+
+#include "Misc/AutomationTest.h"
+#include "Dom/JsonObject.h"
+#include "HAL/PlatformTime.h"
+#include "Math/RandomStream.h"
+#include "Misc/DateTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/JsonSerializer.h"
+#include "UObject/Package.h"
+
+#include "CyclicBuffer.h"
+#include "InputBufferComponent.h"
+#include "InputCommand.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace InputBufferBenchmark
+{
+	/* Generated input runs at 60 frames per second. */
+	static const float FrameTime = 1.f / 60.f;
+
+	static const int32 NumFrames = 4096;
+	static const int32 NumQueries = 512;
+	static const int32 HistorySizes[] = { 16, 128, 512 };
+
+	/* Generated input events and the commands to recognize in them. */
+	struct FStream
+	{
+		FString Name;
+
+		/* Registered as translated events, which need no keys. */
+		TArray<FName> Events;
+
+		/* Raised events of each frame, as indices into Events. */
+		TArray<TArray<int32>> Frames;
+
+		/* Each command is a single sequence of entries, and each entry is a list of indices into Events. */
+		TArray<TArray<TArray<int32>>> Commands;
+	};
+
+	struct FResult
+	{
+		FString Stream;
+		int32 MaxInputHistory;
+		FString Operation;
+		int32 NumOps;
+		double NsPerOp;
+	};
+
+	/* Runs a function a number of times and returns nanoseconds per call. */
+	template <typename FunctionType>
+	double MeasureNsPerOp(int32 NumOps, FunctionType&& Function)
+	{
+		const uint64 StartCycles = FPlatformTime::Cycles64();
+		for (int32 Idx = 0; Idx < NumOps; Idx++)
+		{
+			Function(Idx);
+		}
+		return FPlatformTime::ToSeconds64(FPlatformTime::Cycles64() - StartCycles) * 1e9 / NumOps;
+	}
+
+	enum EDirection { Up, Down, Left, Right, Punch, Kick };
+
+	FStream MakeBasicStream(const FString& Name)
+	{
+		FStream Stream;
+		Stream.Name = Name;
+		Stream.Events = { TEXT("Up"), TEXT("Down"), TEXT("Left"), TEXT("Right"), TEXT("Punch"), TEXT("Kick") };
+
+		// Quarter-circle forward punch, dragon punch, and punch into kick.
+		Stream.Commands.Add({ { Down }, { Down, Right }, { Right }, { Punch } });
+		Stream.Commands.Add({ { Right }, { Down }, { Down, Right }, { Punch } });
+		Stream.Commands.Add({ { Punch }, { Kick } });
+		return Stream;
+	}
+
+	/* Buttons and directions change almost every frame. */
+	FStream MakeMashingStream(FRandomStream& Random)
+	{
+		FStream Stream = MakeBasicStream(TEXT("Mashing"));
+		for (int32 Frame = 0; Frame < NumFrames; Frame++)
+		{
+			TArray<int32>& Events = Stream.Frames.AddDefaulted_GetRef();
+			Events.Add(Random.RandRange(Up, Right));
+			if (Random.FRand() < 0.5f)
+			{
+				Events.Add(Random.RandHelper(2) == 0 ? Punch : Kick);
+			}
+		}
+		return Stream;
+	}
+
+	/* Directions are held for a long time, so most frames prolong the last record. */
+	FStream MakeLongHoldStream(FRandomStream& Random)
+	{
+		FStream Stream = MakeBasicStream(TEXT("LongHolds"));
+		while (Stream.Frames.Num() < NumFrames)
+		{
+			const int32 Direction = Random.RandRange(Up, Right);
+			const int32 HoldFrames = Random.RandRange(30, 120);
+			for (int32 Frame = 0; Frame < HoldFrames; Frame++)
+			{
+				TArray<int32>& Events = Stream.Frames.AddDefaulted_GetRef();
+				Events.Add(Direction);
+				if (Frame == HoldFrames - 1 && Random.RandHelper(2) == 0)
+				{
+					Events.Add(Punch);
+				}
+			}
+		}
+		Stream.Frames.SetNum(NumFrames);
+		return Stream;
+	}
+
+	/* Motion inputs with jittered timing and idle frames in between. */
+	FStream MakeMotionStream(FRandomStream& Random)
+	{
+		FStream Stream = MakeBasicStream(TEXT("MotionInputs"));
+		const TArray<TArray<TArray<int32>>> Motions = {
+			{ { Down }, { Down, Right }, { Right }, { Right, Punch } },
+			{ { Right }, { Down }, { Down, Right }, { Down, Right, Punch } },
+			{ { Punch }, {}, { Kick } },
+		};
+
+		while (Stream.Frames.Num() < NumFrames)
+		{
+			for (const TArray<int32>& Step : Motions[Random.RandHelper(Motions.Num())])
+			{
+				const int32 StepFrames = Random.RandRange(1, 5);
+				for (int32 Frame = 0; Frame < StepFrames; Frame++)
+				{
+					Stream.Frames.Add(Step);
+				}
+			}
+			for (int32 Frame = Random.RandRange(0, 10); Frame > 0; Frame--)
+			{
+				Stream.Frames.AddDefaulted();
+			}
+		}
+		Stream.Frames.SetNum(NumFrames);
+		return Stream;
+	}
+
+	/* 64 events with a few of them raised at a time. */
+	FStream MakeWideStream(FRandomStream& Random)
+	{
+		FStream Stream;
+		Stream.Name = TEXT("WideSetup");
+
+		const int32 NumEvents = FMath::Min(64, (int32)FInputBufferRecord::MAX_EVENTS);
+		for (int32 Idx = 0; Idx < NumEvents; Idx++)
+		{
+			Stream.Events.Add(*FString::Printf(TEXT("Event%d"), Idx));
+		}
+
+		for (int32 CommandIdx = 0; CommandIdx < 8; CommandIdx++)
+		{
+			TArray<TArray<int32>>& Entries = Stream.Commands.AddDefaulted_GetRef();
+			for (int32 EntryIdx = Random.RandRange(2, 4); EntryIdx > 0; EntryIdx--)
+			{
+				Entries.Add({ Random.RandHelper(NumEvents) });
+			}
+		}
+
+		while (Stream.Frames.Num() < NumFrames)
+		{
+			TArray<int32> Events;
+			for (int32 Count = Random.RandRange(1, 3); Count > 0; Count--)
+			{
+				Events.AddUnique(Random.RandHelper(NumEvents));
+			}
+			for (int32 Frame = Random.RandRange(1, 8); Frame > 0; Frame--)
+			{
+				Stream.Frames.Add(Events);
+			}
+		}
+		Stream.Frames.SetNum(NumFrames);
+		return Stream;
+	}
+
+	TArray<UInputCommand*> CreateCommands(const FStream& Stream)
+	{
+		TArray<UInputCommand*> Commands;
+		for (const TArray<TArray<int32>>& Entries : Stream.Commands)
+		{
+			auto Command = NewObject<UInputCommand>(GetTransientPackage());
+			Command->TimeLimit = 1.f;
+			FInputCommandSequence& Sequence = Command->Sequences.AddDefaulted_GetRef();
+			for (const TArray<int32>& Events : Entries)
+			{
+				FInputCommandEntry& Entry = Sequence.Entries.AddDefaulted_GetRef();
+				for (int32 Event : Events)
+				{
+					Entry.EventsToMatch.Add(Stream.Events[Event]);
+				}
+			}
+			Commands.Add(Command);
+		}
+		return Commands;
+	}
+
+	void Run(const FStream& Stream, int32 MaxInputHistory, TArray<FResult>& Results)
+	{
+		const TArray<UInputCommand*> Commands = CreateCommands(Stream);
+
+		auto InputBuffer = NewObject<UInputBufferComponent>(GetTransientPackage());
+		InputBuffer->TranslatedEvents = Stream.Events;
+		InputBuffer->MaxInputHistory = MaxInputHistory;
+		InputBuffer->WatchedCommands = Commands;
+		InputBuffer->Initialize();
+
+		// Event indices follow the order of registration.
+		TArray<FInputEventFlags> Frames;
+		for (const TArray<int32>& Events : Stream.Frames)
+		{
+			FInputEventFlags& Flags = Frames.AddDefaulted_GetRef();
+			for (int32 Event : Events)
+			{
+				Flags.SetBit(Event);
+			}
+		}
+
+		// Without a world, the current time of the input buffer is zero, so input ends at time zero.
+		auto AddResult = [&Results, &Stream, MaxInputHistory](const TCHAR* Operation, int32 NumOps, double NsPerOp)
+		{
+			Results.Add({ Stream.Name, MaxInputHistory, Operation, NumOps, NsPerOp });
+		};
+
+		AddResult(TEXT("ProcessEvents"), NumFrames, MeasureNsPerOp(NumFrames, [InputBuffer, &Frames](int32 Frame)
+		{
+			InputBuffer->ProcessEvents(Frames[Frame], (Frame - NumFrames + 1) * FrameTime);
+		}));
+
+		bool bAnyMatched = false;
+		AddResult(TEXT("MatchCommand"), NumQueries, MeasureNsPerOp(NumQueries, [InputBuffer, &Commands, &bAnyMatched](int32 Query)
+		{
+			bAnyMatched |= InputBuffer->MatchCommand(Commands[Query % Commands.Num()]);
+		}));
+
+		TArray<UInputCommand*> Matched;
+		AddResult(TEXT("MatchCommands"), NumQueries, MeasureNsPerOp(NumQueries, [InputBuffer, &Commands, &Matched](int32 Query)
+		{
+			Matched.Reset();
+			InputBuffer->MatchCommands(Commands, Matched);
+		}));
+
+		TArray<FInputHistoryRecord> Records;
+		AddResult(TEXT("GetHistoryRecords"), NumQueries, MeasureNsPerOp(NumQueries, [InputBuffer, &Records](int32 Query)
+		{
+			Records.Reset();
+			InputBuffer->GetHistoryRecords(Records);
+		}));
+
+		AddResult(TEXT("SetHistoryRecords"), NumQueries, MeasureNsPerOp(NumQueries, [InputBuffer, &Records](int32 Query)
+		{
+			InputBuffer->SetHistoryRecords(Records);
+		}));
+
+		TCyclicBuffer<FInputBufferRecord> CyclicBuffer;
+		CyclicBuffer.Reset(MaxInputHistory);
+		AddResult(TEXT("CyclicBufferPush"), NumFrames, MeasureNsPerOp(NumFrames, [&CyclicBuffer, &Frames](int32 Frame)
+		{
+			const float Time = Frame * FrameTime;
+			CyclicBuffer.Push(FInputBufferRecord(Time, Time, Frames[Frame], FInputEventFlags()));
+		}));
+
+		int32 NumNonEmpty = 0;
+		AddResult(TEXT("CyclicBufferReverseScan"), NumQueries, MeasureNsPerOp(NumQueries, [&CyclicBuffer, &NumNonEmpty](int32 Query)
+		{
+			for (auto It = CyclicBuffer.CreateConstReverseIterator(); It; ++It)
+			{
+				NumNonEmpty += It->Events.IsZero() ? 0 : 1;
+			}
+		}));
+
+		const TCyclicBuffer<FInputBufferRecord>& ConstCyclicBuffer = CyclicBuffer;
+		AddResult(TEXT("CyclicBufferSpanScan"), NumQueries, MeasureNsPerOp(NumQueries, [&ConstCyclicBuffer, &NumNonEmpty](int32 Query)
+		{
+			TArrayView<const FInputBufferRecord> FirstSpan, SecondSpan;
+			ConstCyclicBuffer.GetSpans(FirstSpan, SecondSpan);
+			for (const FInputBufferRecord& Record : FirstSpan)
+			{
+				NumNonEmpty += Record.Events.IsZero() ? 0 : 1;
+			}
+			for (const FInputBufferRecord& Record : SecondSpan)
+			{
+				NumNonEmpty += Record.Events.IsZero() ? 0 : 1;
+			}
+		}));
+
+		TArray<FInputBufferRecord> ExportedRecords;
+		AddResult(TEXT("CyclicBufferCopyTo"), NumQueries, MeasureNsPerOp(NumQueries, [&CyclicBuffer, &ExportedRecords](int32 Query)
+		{
+			CyclicBuffer.CopyTo(ExportedRecords);
+		}));
+
+		TPowerOfTwoCyclicBuffer<FInputBufferRecord> PowerOfTwoBuffer;
+		PowerOfTwoBuffer.Reset(MaxInputHistory);
+		AddResult(TEXT("PowerOfTwoCyclicBufferPush"), NumFrames, MeasureNsPerOp(NumFrames, [&PowerOfTwoBuffer, &Frames](int32 Frame)
+		{
+			const float Time = Frame * FrameTime;
+			PowerOfTwoBuffer.Push(FInputBufferRecord(Time, Time, Frames[Frame], FInputEventFlags()));
+		}));
+
+		AddResult(TEXT("PowerOfTwoCyclicBufferForwardScan"), NumQueries, MeasureNsPerOp(NumQueries, [&PowerOfTwoBuffer, &NumNonEmpty](int32 Query)
+		{
+			for (const FInputBufferRecord& Record : PowerOfTwoBuffer)
+			{
+				NumNonEmpty += Record.Events.IsZero() ? 0 : 1;
+			}
+		}));
+
+		// Keep the results observable so that the measured calls are not optimized away.
+		UE_LOG(LogTemp, Verbose, TEXT("%s/%d: matched %d, %d records, %d non-empty."), *Stream.Name, MaxInputHistory, bAnyMatched, Records.Num(), NumNonEmpty);
+	}
+
+	FString ToJson(const TArray<FResult>& Results)
+	{
+		TSharedRef<FJsonObject> Root = MakeShared<FJsonObject>();
+		Root->SetStringField(TEXT("Timestamp"), FDateTime::UtcNow().ToIso8601());
+		Root->SetNumberField(TEXT("MaxEvents"), FInputBufferRecord::MAX_EVENTS);
+		Root->SetNumberField(TEXT("NumFrames"), NumFrames);
+
+		TArray<TSharedPtr<FJsonValue>> Values;
+		for (const FResult& Result : Results)
+		{
+			TSharedRef<FJsonObject> Object = MakeShared<FJsonObject>();
+			Object->SetStringField(TEXT("Stream"), Result.Stream);
+			Object->SetNumberField(TEXT("MaxInputHistory"), Result.MaxInputHistory);
+			Object->SetStringField(TEXT("Operation"), Result.Operation);
+			Object->SetNumberField(TEXT("NumOps"), Result.NumOps);
+			Object->SetNumberField(TEXT("NsPerOp"), Result.NsPerOp);
+			Values.Add(MakeShared<FJsonValueObject>(Object));
+		}
+		Root->SetArrayField(TEXT("Results"), Values);
+
+		FString Json;
+		TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&Json);
+		FJsonSerializer::Serialize(Root, Writer);
+		return Json;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInputBufferBenchmark, "Plugins.InputBuffer.Benchmark", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FInputBufferBenchmark::RunTest(const FString& Parameters)
+{
+	using namespace InputBufferBenchmark;
+
+	// A fixed seed makes the generated input the same between runs.
+	FRandomStream Random(2018);
+
+	TArray<FStream> Streams;
+	Streams.Add(MakeMashingStream(Random));
+	Streams.Add(MakeLongHoldStream(Random));
+	Streams.Add(MakeMotionStream(Random));
+	Streams.Add(MakeWideStream(Random));
+
+	TArray<FResult> Results;
+	for (const FStream& Stream : Streams)
+	{
+		for (int32 MaxInputHistory : HistorySizes)
+		{
+			Run(Stream, MaxInputHistory, Results);
+		}
+	}
+
+	for (const FResult& Result : Results)
+	{
+		AddInfo(FString::Printf(TEXT("%s/%d %s: %.1f ns/op"), *Result.Stream, Result.MaxInputHistory, *Result.Operation, Result.NsPerOp));
+	}
+
+	const FString Path = FPaths::ProjectSavedDir() / TEXT("Automation") / TEXT("InputBufferBenchmark") / FString::Printf(TEXT("%s.json"), *FDateTime::Now().ToString());
+	TestTrue(TEXT("Benchmark results should be saved."), FFileHelper::SaveStringToFile(ToJson(Results), *Path));
+	AddInfo(FString::Printf(TEXT("Benchmark results saved to %s"), *Path));
+
+	return true;
+}
+
+#endif //WITH_DEV_AUTOMATION_TESTS
@@ -6,6 +6,7 @@
 #include "InputBufferComponent.h"
 #include "InputBufferPlayerController.h"
 #include "InputCommand.h"
+#include "InputCommandSetMatcher.h"
 
 #if WITH_DEV_AUTOMATION_TESTS
 
@@ -154,6 +155,43 @@ bool FInputBufferTest::RunTest(const FString& Parameters)
 
 			TestTrue(TEXT("Event matching should succeed if last events match."), InputBuffer->MatchEvents(EventsToMatch, EventsToIgnore, 0.5, true));
 		}
+
+		// Command recognition
+		{
+			auto InputCommand = NewObject<UInputCommand>();
+			InputCommand->Sequences.AddDefaulted();
+			InputCommand->Sequences[0].Entries.AddDefaulted();
+			InputCommand->Sequences[0].Entries[0].EventsToMatch.Add(TEXT("Punch"));
+			InputCommand->Sequences[0].Entries[0].EventsToIgnore.Add(TEXT("Forward"));
+
+			TestTrue(TEXT("Command recognition should succeed if the last non-empty events match."), InputBuffer->MatchCommand(InputCommand));
+
+			auto UnknownCommand = NewObject<UInputCommand>();
+			UnknownCommand->Sequences.AddDefaulted();
+			UnknownCommand->Sequences[0].Entries.AddDefaulted();
+			UnknownCommand->Sequences[0].Entries[0].EventsToMatch.Add(TEXT("Fire"));
+
+			TestFalse(TEXT("Command recognition should fail if given input command refers to unknown events."), InputBuffer->MatchCommand(UnknownCommand));
+
+			TArray<UInputCommand*> Commands;
+			Commands.Add(UnknownCommand);
+			Commands.Add(InputCommand);
+
+			TArray<UInputCommand*> MatchedCommands;
+			TestTrue(TEXT("Recognition of a command set should succeed if any command matches."), InputBuffer->MatchCommands(Commands, MatchedCommands));
+			TestTrue(TEXT("Recognition of a command set should output exactly the matching commands."), MatchedCommands.Num() == 1 && MatchedCommands[0] == InputCommand);
+			TestTrue(TEXT("Prioritized recognition should return the first matching command."), InputBuffer->MatchFirstCommand(Commands) == InputCommand);
+
+			InputBuffer->WatchCommand(InputCommand);
+			InputBuffer->WatchCommand(UnknownCommand);
+			TestTrue(TEXT("Incremental recognition should agree with command recognition on matching commands."), InputBuffer->IsCommandRecognized(InputCommand));
+			TestFalse(TEXT("Incremental recognition should agree with command recognition on mismatching commands."), InputBuffer->IsCommandRecognized(UnknownCommand));
+			InputBuffer->UnwatchCommand(InputCommand);
+			InputBuffer->UnwatchCommand(UnknownCommand);
+
+			TestTrue(TEXT("Consuming a command should succeed if the command matches."), InputBuffer->ConsumeCommand(InputCommand));
+			TestFalse(TEXT("Command recognition should fail if the matching input has been consumed."), InputBuffer->MatchCommand(InputCommand));
+		}
 	}
 
 	// Input history assignment with an unknown event
@@ -211,6 +249,96 @@ bool FInputBufferTest::RunTest(const FString& Parameters)
 		TestFalse(TEXT("Command recognition should fail if input history is empty."), InputBuffer->MatchCommand(InputCommand));
 	}
 
+	// Command set matching with shared entries
+	{
+		TMap<FName, int32> EventIndexMap;
+		EventIndexMap.Add(TEXT("Down"), 0);
+		EventIndexMap.Add(TEXT("Forward"), 1);
+		EventIndexMap.Add(TEXT("Punch"), 2);
+		EventIndexMap.Add(TEXT("Kick"), 3);
+
+		// Down, Forward and then Punch or Kick, alternately.
+		const int32 MaxCommands = 64;
+		TArray<FCompiledInputCommand> Compiled;
+		Compiled.SetNum(MaxCommands);
+		for (int32 Idx = 0; Idx < MaxCommands; Idx++)
+		{
+			auto InputCommand = NewObject<UInputCommand>();
+			InputCommand->Sequences.AddDefaulted();
+			InputCommand->Sequences[0].Entries.AddDefaulted(3);
+			InputCommand->Sequences[0].Entries[0].EventsToMatch.Add(TEXT("Down"));
+			InputCommand->Sequences[0].Entries[1].EventsToMatch.Add(TEXT("Forward"));
+			InputCommand->Sequences[0].Entries[2].EventsToMatch.Add(Idx % 2 == 0 ? TEXT("Punch") : TEXT("Kick"));
+			Compiled[Idx].Compile(*InputCommand, EventIndexMap);
+		}
+
+		const FInputBufferRecord Records[] =
+		{
+			FInputBufferRecord(1.f, 1.1f, FInputEventFlags::FromBit(0), FInputEventFlags()),
+			FInputBufferRecord(1.1f, 1.2f, FInputEventFlags::FromBit(1), FInputEventFlags()),
+			FInputBufferRecord(1.2f, 1.3f, FInputEventFlags::FromBit(2), FInputEventFlags()),
+		};
+
+		int32 FewWork = 0;
+		for (int32 NumCommands : { 2, MaxCommands })
+		{
+			FInputCommandSetMatcher Matcher;
+			for (int32 Idx = 0; Idx < NumCommands; Idx++)
+			{
+				Matcher.AddCommand(&Compiled[Idx]);
+			}
+
+			Matcher.Begin();
+			for (int32 RecordIdx = ARRAY_COUNT(Records) - 1; RecordIdx >= 0; RecordIdx--)
+			{
+				if (!Matcher.Step(Records[RecordIdx], 1.3f))
+				{
+					break;
+				}
+			}
+			Matcher.Finish();
+
+			bool bResultsCorrect = true;
+			for (int32 Idx = 0; Idx < NumCommands; Idx++)
+			{
+				bResultsCorrect &= Matcher.GetResults()[Idx] == (Idx % 2 == 0 ? EInputCommandMatchResult::Matched : EInputCommandMatchResult::Failed);
+			}
+			TestTrue(TEXT("Commands sharing entries must be matched independently."), bResultsCorrect);
+			TestEqual(TEXT("Commands with the same entries must share nodes of the automaton."), Matcher.NumNodes(), 6);
+			TestEqual(TEXT("Entries with the same events must share tests of the automaton."), Matcher.NumTests(), 4);
+
+			if (NumCommands == 2)
+			{
+				FewWork = Matcher.GetMaxStepWork();
+			}
+			else
+			{
+				TestEqual(TEXT("The work per record must not grow with the number of sequences sharing entries."), Matcher.GetMaxStepWork(), FewWork);
+			}
+		}
+	}
+
+	// Stick quantization
+	{
+		TArray<FBufferedInputStickSetup> StickSetups;
+		FBufferedInputStickSetup& StickSetup = StickSetups.AddDefaulted_GetRef();
+		StickSetup.Name = TEXT("Move");
+		StickSetup.XAxis = EKeys::Gamepad_LeftX;
+		StickSetup.YAxis = EKeys::Gamepad_LeftY;
+
+		auto Compiled = FCompiledInputBufferSchema::Compile(TArray<FBufferedInputEventSetup>(), StickSetups, TArray<FName>(), TArray<FBufferedInputEventKeyMapping>(), TArray<UInputCommand*>());
+		TestEqual(TEXT("A stick must register eight direction events."), Compiled->Events.Num(), FCompiledInputStick::NUM_DIRECTIONS);
+		TestTrue(TEXT("Direction events must be named after the stick."), Compiled->EventIndexMap.Contains(TEXT("MoveDownRight")));
+
+		const FCompiledInputStick& Stick = Compiled->Sticks[0];
+		TestEqual(TEXT("A stick within the dead zone must be neutral."), Stick.Quantize(0.1f, 0.1f, INDEX_NONE), (int32)INDEX_NONE);
+		TestEqual(TEXT("A stick pushed down must point down."), Stick.Quantize(0.f, -1.f, INDEX_NONE), 6);
+		TestEqual(TEXT("A stick pushed down-left must point down-left."), Stick.Quantize(-0.7f, -0.7f, INDEX_NONE), 5);
+		TestEqual(TEXT("A stick just past the border of its direction must keep it."), Stick.Quantize(FMath::Cos(PI / 7.f), FMath::Sin(PI / 7.f), 0), 0);
+		TestEqual(TEXT("A stick far past the border of its direction must change it."), Stick.Quantize(FMath::Cos(PI / 5.f), FMath::Sin(PI / 5.f), 0), 1);
+		TestEqual(TEXT("A stick slightly within the dead zone must keep its direction."), Stick.Quantize(0.28f, 0.f, 0), 0);
+	}
+
 	return true;
 }
 
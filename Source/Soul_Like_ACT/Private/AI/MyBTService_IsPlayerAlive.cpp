@@ -28,7 +28,7 @@ void UMyBTService_IsTargetAvailable::TickNode(UBehaviorTreeComponent& OwnerComp,
     }
     ASoulCharacterBase* PlayerPawn = Cast<ASoulCharacterBase>(
         OwnerComp.GetBlackboardComponent()->GetValueAsObject("PlayerPawn"));
-    if (!PlayerPawn || PlayerPawn->GetHealth() <= 0)
+    if (!PlayerPawn || PlayerPawn->GetIsDead() || PlayerPawn->GetHealth() <= 0)
     {
         OwnerComp.GetBlackboardComponent()->SetValueAsBool(GetSelectedBlackboardKey(), 0);
         return;
@@ -4,6 +4,7 @@
 #include "GameplayEffect.h"
 #include "SoulCharacterBase.h"
 #include "GameplayEffectExtension.h"
+#include "Types/SoulGameplayTags.h"
 
 
 USoulAttributeSet::USoulAttributeSet()
@@ -56,92 +57,135 @@ void USoulAttributeSet::PreAttributeChange(const FGameplayAttribute& Attribute,
     }
 }
 
-void USoulAttributeSet::PostGameplayEffectExecute(const FGameplayEffectModCallbackData& Data)
+void USoulAttributeSet::BeginPendingHit(const FGameplayEffectModCallbackData& Data)
 {
-    Super::PostGameplayEffectExecute(Data);
-
     FGameplayEffectContextHandle Context = Data.EffectSpec.GetContext();
     UAbilitySystemComponent* Source = Context.GetOriginalInstigatorAbilitySystemComponent();
-    //const FGameplayTagContainer& SourceTags = *Data.EffectSpec.CapturedSourceTags.GetAggregatedTags();
-    //const FGameplayTagContainer& TargetTags = *Data.EffectSpec.CapturedTargetTags.GetAggregatedTags();
-    const FGameplayTagContainer& EffectSpecTags = Data.EffectSpec.DynamicAssetTags;
 
+    bHasPendingHit = true;
+    PendingHitDef = Data.EffectSpec.Def;
+    PendingHitContext = Context;
+    PendingHit = FSoulHitRecord();
+
+    // Get the Source actor
+    AActor* SourceActor = nullptr;
+    AController* SourceController = nullptr;
+    ASoulCharacterBase* SourceCharacter = nullptr;
+    if (Source && Source->AbilityActorInfo.IsValid() && Source->AbilityActorInfo->AvatarActor.IsValid())
+    {
+        SourceActor = Source->AbilityActorInfo->AvatarActor.Get();
+        SourceController = Source->AbilityActorInfo->PlayerController.Get();
+        if (SourceController == nullptr && SourceActor != nullptr)
+        {
+            if (APawn* Pawn = Cast<APawn>(SourceActor))
+            {
+                SourceController = Pawn->GetController();
+            }
+        }
+
+        // Use the controller to find the source pawn
+        if (SourceController)
+        {
+            SourceCharacter = Cast<ASoulCharacterBase>(SourceController->GetPawn());
+        }
+        else
+        {
+            SourceCharacter = Cast<ASoulCharacterBase>(SourceActor);
+        }
+
+        // Set the causer actor based on context if it's set
+        if (Context.GetEffectCauser())
+        {
+            SourceActor = Context.GetEffectCauser();
+        }
+    }
+
+    PendingHit.InstigatorCharacter = SourceCharacter;
+    PendingHit.DamageCauser = SourceActor;
 
-    // Compute the delta between old and new, if it is available
-    float DeltaValue = 0;
-    if (Data.EvaluatedData.ModifierOp == EGameplayModOp::Type::Additive)
+    // Try to extract a hit result
+    if (Context.GetHitResult())
     {
-        // If this was additive, store the raw delta value to be passed along later
-        DeltaValue = Data.EvaluatedData.Magnitude;
+        PendingHit.HitInfo = *Context.GetHitResult();
     }
 
+    /**
+     * Data.EffectSpec == FGameplayEffectSpec
+     * Data.EffectSpec.DynamicAssetTags
+     */
+    const FGameplayTagContainer& EffectSpecTags = Data.EffectSpec.DynamicAssetTags;
+    PendingHit.DamageTags = EffectSpecTags;
+    PendingHit.bIsCritical = EffectSpecTags.HasTagExact(FSoulGameplayTags::Get().Damage_Critical);
+    PendingHit.bIsStun = EffectSpecTags.HasTagExact(FSoulGameplayTags::Get().Damage_Stun);
+
+    FGameplayTagContainer LocalContainer;
+    Data.EffectSpec.GetAllAssetTags(LocalContainer);
+    PendingHit.bIsDot = LocalContainer.HasTagExact(FSoulGameplayTags::Get().Damage_Dot);
+}
+
+bool USoulAttributeSet::IsPendingHitSpec(const FGameplayEffectSpec& Spec) const
+{
+    return bHasPendingHit && Spec.Def == PendingHitDef && Spec.GetContext() == PendingHitContext;
+}
+
+void USoulAttributeSet::FlushPendingHit(const FGameplayEffectSpec& ExecutedSpec)
+{
+    // Effects applied while the hit executes, like the dead GE, must not cut it short
+    if (IsPendingHitSpec(ExecutedSpec))
+        DeliverPendingHit();
+}
+
+void USoulAttributeSet::DeliverPendingHit()
+{
+    if (!bHasPendingHit)
+        return;
+
+    bHasPendingHit = false;
+    PendingHitDef = nullptr;
+    PendingHitContext = FGameplayEffectContextHandle();
+
+    const FGameplayAbilityActorInfo* ActorInfo = GetActorInfo();
+    if (ASoulCharacterBase* TargetCharacter = ActorInfo ? Cast<ASoulCharacterBase>(ActorInfo->AvatarActor.Get()) : nullptr)
+        TargetCharacter->HandleHit(PendingHit);
+
+    PendingHit = FSoulHitRecord();
+}
+
+void USoulAttributeSet::PostGameplayEffectExecute(const FGameplayEffectModCallbackData& Data)
+{
+    Super::PostGameplayEffectExecute(Data);
+
     // Get the Target actor, which should be our owner
     AActor* TargetActor = nullptr;
-    AController* TargetController = nullptr;
     ASoulCharacterBase* TargetCharacter = nullptr;
     if (Data.Target.AbilityActorInfo.IsValid() && Data.Target.AbilityActorInfo->AvatarActor.IsValid())
     {
         TargetActor = Data.Target.AbilityActorInfo->AvatarActor.Get();
-        TargetController = Data.Target.AbilityActorInfo->PlayerController.Get();
         TargetCharacter = Cast<ASoulCharacterBase>(TargetActor);
     }
 
-    if (Data.EvaluatedData.Attribute == GetDamageAttribute())
+    // Damage and PostureDamage outputs of one spec are gathered into a single hit,
+    // which the owner flushes once the spec has executed
+    if (Data.EvaluatedData.Attribute == GetDamageAttribute() ||
+        Data.EvaluatedData.Attribute == GetPostureDamageAttribute())
     {
-        // Get the Source actor
-        AActor* SourceActor = nullptr;
-        AController* SourceController = nullptr;
-        ASoulCharacterBase* SourceCharacter = nullptr;
-        if (Source && Source->AbilityActorInfo.IsValid() && Source->AbilityActorInfo->AvatarActor.IsValid())
-        {
-            SourceActor = Source->AbilityActorInfo->AvatarActor.Get();
-            SourceController = Source->AbilityActorInfo->PlayerController.Get();
-            if (SourceController == nullptr && SourceActor != nullptr)
-            {
-                if (APawn* Pawn = Cast<APawn>(SourceActor))
-                {
-                    SourceController = Pawn->GetController();
-                }
-            }
-
-            // Use the controller to find the source pawn
-            if (SourceController)
-            {
-                SourceCharacter = Cast<ASoulCharacterBase>(SourceController->GetPawn());
-            }
-            else
-            {
-                SourceCharacter = Cast<ASoulCharacterBase>(SourceActor);
-            }
-
-            // Set the causer actor based on context if it's set
-            if (Context.GetEffectCauser())
-            {
-                SourceActor = Context.GetEffectCauser();
-            }
-        }
-
-        // Try to extract a hit result
-        FHitResult HitResult;
-        if (Context.GetHitResult())
+        if (!IsPendingHitSpec(Data.EffectSpec))
         {
-            HitResult = *Context.GetHitResult();
+            // Only left over if its spec was never flushed
+            DeliverPendingHit();
+            BeginPendingHit(Data);
         }
+    }
 
-        /**
-         * Data.EffectSpec == FGameplayEffectSpec
-         * Data.EffectSpec.DynamicAssetTags
-         */
-        bool bIsCritic = Data.EffectSpec.DynamicAssetTags.HasTagExact(
-            FGameplayTag::RequestGameplayTag(FName{"Damage.Critical"}, true));
-
-        bool bIsStun = Data.EffectSpec.DynamicAssetTags.HasTagExact(
-            FGameplayTag::RequestGameplayTag(FName{"Damage.Stun"}, true));
-
+    if (Data.EvaluatedData.Attribute == GetDamageAttribute())
+    {
         // Store a local copy of the amount of damage done and clear the damage attribute
         const float LocalDamageDone = GetDamage();
         SetDamage(0.f);
 
+        PendingHit.DamageAmount += LocalDamageDone;
+        PendingHit.bHasDamage = true;
+
         if (LocalDamageDone > 0)
         {
             // Apply the health change and then clamp it
@@ -151,100 +195,35 @@ void USoulAttributeSet::PostGameplayEffectExecute(const FGameplayEffectModCallba
             //On-Kill Proc
             if (GetHealth() <= 0.f)
             {
-                (Cast<ASoulCharacterBase>(SourceActor))->
-                    Notify_OnMeleeKill(SourceActor, TargetActor, HitResult);
+                (Cast<ASoulCharacterBase>(PendingHit.DamageCauser))->
+                    Notify_OnMeleeKill(PendingHit.DamageCauser, TargetActor, PendingHit.HitInfo);
 
                 if(OldHealth > 0.f)
-                    TargetCharacter->HandleOnDead(HitResult, EffectSpecTags, SourceCharacter,
-                          SourceActor);
+                    TargetCharacter->HandleOnDead(PendingHit.HitInfo, PendingHit.DamageTags,
+                                                  PendingHit.InstigatorCharacter, PendingHit.DamageCauser);
             }
         }
-        
-        if (TargetCharacter)
-        {
-            FGameplayTagContainer LocalContainer;
-            Data.EffectSpec.GetAllAssetTags(LocalContainer);
-
-            //Dot damage
-            if (LocalContainer.HasTagExact(FGameplayTag::RequestGameplayTag(FName{"Damage.Dot"}, true)))
-                TargetCharacter->HandleDotDamage(LocalDamageDone, bIsCritic, bIsStun, HitResult, EffectSpecTags,
-                                                 SourceCharacter, SourceActor);
-            //Hit damage
-            else
-                TargetCharacter->HandleDamage(LocalDamageDone, bIsCritic, bIsStun, HitResult, EffectSpecTags, SourceCharacter,
-                          SourceActor);
-        }
     }
     else if (Data.EvaluatedData.Attribute == GetPostureDamageAttribute())
     {
-        // Get the Source actor
-        AActor* SourceActor = nullptr;
-        AController* SourceController = nullptr;
-        ASoulCharacterBase* SourceCharacter = nullptr;
-        if (Source && Source->AbilityActorInfo.IsValid() && Source->AbilityActorInfo->AvatarActor.IsValid())
-        {
-            SourceActor = Source->AbilityActorInfo->AvatarActor.Get();
-            SourceController = Source->AbilityActorInfo->PlayerController.Get();
-            if (SourceController == nullptr && SourceActor != nullptr)
-            {
-                if (APawn* Pawn = Cast<APawn>(SourceActor))
-                {
-                    SourceController = Pawn->GetController();
-                }
-            }
-
-            // Use the controller to find the source pawn
-            if (SourceController)
-            {
-                SourceCharacter = Cast<ASoulCharacterBase>(SourceController->GetPawn());
-            }
-            else
-            {
-                SourceCharacter = Cast<ASoulCharacterBase>(SourceActor);
-            }
-
-            // Set the causer actor based on context if it's set
-            if (Context.GetEffectCauser())
-            {
-                SourceActor = Context.GetEffectCauser();
-            }
-        }
-
-        // Try to extract a hit result
-        FHitResult HitResult;
-        if (Context.GetHitResult())
-        {
-            HitResult = *Context.GetHitResult();
-        }
-
-        /**
-         * Data.EffectSpec == FGameplayEffectSpec
-         * Data.EffectSpec.DynamicAssetTags
-         */
-        bool bIsCritic = Data.EffectSpec.DynamicAssetTags.HasTagExact(
-            FGameplayTag::RequestGameplayTag(FName{"Damage.Critical"}, true));
-
         // Store a local copy of the amount of damage done and clear the damage attribute
         const float LocalPostureDamageDone = GetPostureDamage();
         SetPostureDamage(0.f);
 
+        PendingHit.PostureDamageAmount += LocalPostureDamageDone;
+
         if (LocalPostureDamageDone > 0)
         {
             // Apply the health change and then clamp it
             const float OldPosture = GetPosture();
             SetPosture(FMath::Clamp(OldPosture + LocalPostureDamageDone, 0.0f, GetMaxPosture()));
 
-            if (TargetCharacter)
+            if (TargetCharacter && !FMath::IsNearlyEqual(OldPosture, GetPosture(), .1f) &&
+                FMath::IsNearlyEqual(GetPosture(), GetMaxPosture(), .1f))
             {
-                // This is proper damage
-                TargetCharacter->HandlePostureDamage(LocalPostureDamageDone, bIsCritic, HitResult, EffectSpecTags,
-                                                     SourceCharacter, SourceActor);
-
-                if(!FMath::IsNearlyEqual(OldPosture, GetPosture(), .1f) && FMath::IsNearlyEqual(GetPosture(), GetMaxPosture(), .1f))
-                {
-                    TargetCharacter->HandleOnCrumble(LocalPostureDamageDone, bIsCritic, HitResult, EffectSpecTags,
-                                                     SourceCharacter, SourceActor);
-                }
+                TargetCharacter->HandleOnCrumble(LocalPostureDamageDone, PendingHit.bIsCritical, PendingHit.HitInfo,
+                                                 PendingHit.DamageTags, PendingHit.InstigatorCharacter,
+                                                 PendingHit.DamageCauser);
             }
         }
     }
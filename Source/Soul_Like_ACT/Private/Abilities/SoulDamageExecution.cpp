@@ -5,6 +5,27 @@
 #include "SoulCharacterBase.h"
 #include "AbilitySystemComponent.h"
 #include "BPFL/BPFL_Math.h"
+#include "Types/SoulGameplayTags.h"
+
+// Index of each attribute an execution may capture, used to build the per-policy attribute masks
+namespace ESoulDamageAttribute
+{
+    enum Type : uint32
+    {
+        DefensePower,
+        PostureStrength,
+        AttackPower,
+        Damage,
+        CriticalStrike,
+        CriticalMulti,
+        PostureDamage,
+        PostureCrumble,
+
+        Count
+    };
+}
+
+#define SOUL_DAMAGE_ATTRIBUTE_BIT(Attribute) (1u << ESoulDamageAttribute::Attribute)
 
 struct SoulDamageStatics
 {
@@ -22,6 +43,9 @@ struct SoulDamageStatics
     DECLARE_ATTRIBUTE_CAPTUREDEF(PostureDamage);
     DECLARE_ATTRIBUTE_CAPTUREDEF(PostureCrumble);
 
+    //Capture defs indexed by ESoulDamageAttribute
+    FGameplayEffectAttributeCaptureDefinition Defs[ESoulDamageAttribute::Count];
+
 
     SoulDamageStatics()
     {
@@ -40,6 +64,15 @@ struct SoulDamageStatics
         // Also capture the source's raw Damage, which is normally passed in directly via the execution
         DEFINE_ATTRIBUTE_CAPTUREDEF(USoulAttributeSet, PostureDamage, Source, true);
         DEFINE_ATTRIBUTE_CAPTUREDEF(USoulAttributeSet, PostureCrumble, Source, true);
+
+        Defs[ESoulDamageAttribute::DefensePower] = DefensePowerDef;
+        Defs[ESoulDamageAttribute::PostureStrength] = PostureStrengthDef;
+        Defs[ESoulDamageAttribute::AttackPower] = AttackPowerDef;
+        Defs[ESoulDamageAttribute::Damage] = DamageDef;
+        Defs[ESoulDamageAttribute::CriticalStrike] = CriticalStrikeDef;
+        Defs[ESoulDamageAttribute::CriticalMulti] = CriticalMultiDef;
+        Defs[ESoulDamageAttribute::PostureDamage] = PostureDamageDef;
+        Defs[ESoulDamageAttribute::PostureCrumble] = PostureCrumbleDef;
     }
 };
 
@@ -49,105 +82,187 @@ static const SoulDamageStatics& DamageStatics()
     return DmgStatics;
 }
 
+// Combat state bits of a character, or of captured tags if the actor is not a character
+static uint32 GetCombatState(const AActor* Actor, const FGameplayTagContainer* CapturedTags)
+{
+    if (const ASoulCharacterBase* Character = Cast<ASoulCharacterBase>(Actor))
+        return Character->GetCombatState();
 
-USoulDamageExecution::USoulDamageExecution()
+    return CapturedTags ? ASoulCharacterBase::GetCombatStateFromTags(*CapturedTags) : ESoulCombatState::None;
+}
+
+/**
+ * Captured attribute values of one execution.
+ * Policy::Attributes is the compile-time mask of attributes the execution's formula reads; only those are registered
+ * for capture and evaluated, and reading any other attribute fails to compile.
+ */
+template <typename Policy>
+struct TSoulDamageCapture
+{
+    static constexpr uint32 Attributes = Policy::Attributes;
+
+    float Values[ESoulDamageAttribute::Count] = {};
+
+    static void AddRelevantAttributes(TArray<FGameplayEffectAttributeCaptureDefinition>& OutDefs)
+    {
+        for (uint32 Index = 0; Index < ESoulDamageAttribute::Count; ++Index)
+        {
+            if (Attributes & (1u << Index))
+                OutDefs.Add(DamageStatics().Defs[Index]);
+        }
+    }
+
+    // The mask is a constant, so the loop is unrolled down to the policy's attributes
+    void Evaluate(const FGameplayEffectCustomExecutionParameters& ExecutionParams,
+                  const FAggregatorEvaluateParameters& EvaluationParameters)
+    {
+        for (uint32 Index = 0; Index < ESoulDamageAttribute::Count; ++Index)
+        {
+            if (Attributes & (1u << Index))
+                ExecutionParams.AttemptCalculateCapturedAttributeMagnitude(DamageStatics().Defs[Index],
+                                                                           EvaluationParameters, Values[Index]);
+        }
+    }
+
+    template <ESoulDamageAttribute::Type Attribute>
+    float Get() const
+    {
+        static_assert((Attributes & (1u << Attribute)) != 0, "Attribute is not captured by this execution's policy");
+        return Values[Attribute];
+    }
+};
+
+// Source, target and spec shared by every execution
+struct FSoulExecutionContext
 {
-    RelevantAttributesToCapture.Add(DamageStatics().PostureStrengthDef);
-    RelevantAttributesToCapture.Add(DamageStatics().DamageDef);
+    AActor* SourceActor;
+    AActor* TargetActor;
+
+    //Warning: it's non-static. Be careful when modify the GE
+    FGameplayEffectSpec* Spec;
+
+    const FGameplayTagContainer* SourceTags;
+    const FGameplayTagContainer* TargetTags;
+
+    FAggregatorEvaluateParameters EvaluationParameters;
+
+    explicit FSoulExecutionContext(const FGameplayEffectCustomExecutionParameters& ExecutionParams)
+    {
+        UAbilitySystemComponent* TargetAbilitySystemComponent = ExecutionParams.GetTargetAbilitySystemComponent();
+        UAbilitySystemComponent* SourceAbilitySystemComponent = ExecutionParams.GetSourceAbilitySystemComponent();
+
+        SourceActor = SourceAbilitySystemComponent ? SourceAbilitySystemComponent->AvatarActor : nullptr;
+        TargetActor = TargetAbilitySystemComponent ? TargetAbilitySystemComponent->AvatarActor : nullptr;
 
-    RelevantAttributesToCapture.Add(DamageStatics().AttackPowerDef);
-    RelevantAttributesToCapture.Add(DamageStatics().CriticalStrikeDef);
-    RelevantAttributesToCapture.Add(DamageStatics().CriticalMultiDef);
+        Spec = ExecutionParams.GetOwningSpecForPreExecuteMod();
 
-    RelevantAttributesToCapture.Add(DamageStatics().PostureDamageDef);
-    RelevantAttributesToCapture.Add(DamageStatics().PostureCrumbleDef);
+        // Gather the tags from the source and target as that can affect which buffs should be used
+        SourceTags = Spec->CapturedSourceTags.GetAggregatedTags();
+        TargetTags = Spec->CapturedTargetTags.GetAggregatedTags();
+
+        EvaluationParameters.SourceTags = SourceTags;
+        EvaluationParameters.TargetTags = TargetTags;
+    }
+};
+
+// --------------------------------------
+//	Damage Done = (Damage + AP) * (bCritical ? (1 + CriticalMulti ; 1) - DP
+// --------------------------------------
+
+template <typename CaptureType>
+static float CalcBaseDamage(const CaptureType& Capture)
+{
+    return (Capture.template Get<ESoulDamageAttribute::Damage>() + 1.f) *
+        Capture.template Get<ESoulDamageAttribute::AttackPower>();
 }
 
-USoulReflectionDamageExecution::USoulReflectionDamageExecution()
+template <typename CaptureType>
+static float ApplyDefense(const CaptureType& Capture, float DamageDone)
+{
+    return DamageDone * (DamageDone / (DamageDone + Capture.template Get<ESoulDamageAttribute::DefensePower>()));
+}
+
+template <typename CaptureType>
+static float CalcPostureDamage(const CaptureType& Capture)
+{
+    const float PostureCrumbleFinal = Capture.template Get<ESoulDamageAttribute::PostureCrumble>() + 10.f;
+    return (1.f + Capture.template Get<ESoulDamageAttribute::PostureDamage>()) * PostureCrumbleFinal *
+        (PostureCrumbleFinal / (PostureCrumbleFinal + Capture.template Get<ESoulDamageAttribute::PostureStrength>()));
+}
+
+static void NotifyMeleeAttack(const FSoulExecutionContext& Context)
+{
+    //Passed the critical tag to the gameplay effect spec
+    //We shall see that when the change of the Damage is passed to the target's AttriuteSet
+
+    (Cast<ASoulCharacterBase>(Context.SourceActor))->
+       Notify_OnMeleeAttack(Context.TargetActor, Context.Spec->GetContext().GetHitResult() ? *(Context.Spec->GetContext().GetHitResult()) : FHitResult());
+}
+
+struct FSoulMeleeDamagePolicy
+{
+    static constexpr uint32 Attributes =
+        SOUL_DAMAGE_ATTRIBUTE_BIT(DefensePower) | SOUL_DAMAGE_ATTRIBUTE_BIT(PostureStrength) |
+        SOUL_DAMAGE_ATTRIBUTE_BIT(AttackPower) | SOUL_DAMAGE_ATTRIBUTE_BIT(Damage) |
+        SOUL_DAMAGE_ATTRIBUTE_BIT(CriticalStrike) | SOUL_DAMAGE_ATTRIBUTE_BIT(CriticalMulti) |
+        SOUL_DAMAGE_ATTRIBUTE_BIT(PostureDamage) | SOUL_DAMAGE_ATTRIBUTE_BIT(PostureCrumble);
+};
+
+//Reflection never crits
+struct FSoulReflectionDamagePolicy
+{
+    static constexpr uint32 Attributes =
+        SOUL_DAMAGE_ATTRIBUTE_BIT(DefensePower) | SOUL_DAMAGE_ATTRIBUTE_BIT(PostureStrength) |
+        SOUL_DAMAGE_ATTRIBUTE_BIT(AttackPower) | SOUL_DAMAGE_ATTRIBUTE_BIT(Damage) |
+        SOUL_DAMAGE_ATTRIBUTE_BIT(PostureDamage) | SOUL_DAMAGE_ATTRIBUTE_BIT(PostureCrumble);
+};
+
+//Dot only deals health damage
+struct FSoulDotDamagePolicy
 {
-    RelevantAttributesToCapture.Add(DamageStatics().PostureStrengthDef);
-    RelevantAttributesToCapture.Add(DamageStatics().DamageDef);
+    static constexpr uint32 Attributes =
+        SOUL_DAMAGE_ATTRIBUTE_BIT(DefensePower) | SOUL_DAMAGE_ATTRIBUTE_BIT(AttackPower) |
+        SOUL_DAMAGE_ATTRIBUTE_BIT(Damage);
+};
+
+#undef SOUL_DAMAGE_ATTRIBUTE_BIT
 
-    RelevantAttributesToCapture.Add(DamageStatics().AttackPowerDef);
-    RelevantAttributesToCapture.Add(DamageStatics().CriticalStrikeDef);
-    RelevantAttributesToCapture.Add(DamageStatics().CriticalMultiDef);
 
-    RelevantAttributesToCapture.Add(DamageStatics().PostureDamageDef);
-    RelevantAttributesToCapture.Add(DamageStatics().PostureCrumbleDef);
+USoulDamageExecution::USoulDamageExecution()
+{
+    TSoulDamageCapture<FSoulMeleeDamagePolicy>::AddRelevantAttributes(RelevantAttributesToCapture);
+}
+
+USoulReflectionDamageExecution::USoulReflectionDamageExecution()
+{
+    TSoulDamageCapture<FSoulReflectionDamagePolicy>::AddRelevantAttributes(RelevantAttributesToCapture);
 }
 
 void USoulReflectionDamageExecution::Execute_Implementation(
     const FGameplayEffectCustomExecutionParameters& ExecutionParams,
     FGameplayEffectCustomExecutionOutput& OutExecutionOutput) const
 {
- UAbilitySystemComponent* TargetAbilitySystemComponent = ExecutionParams.GetTargetAbilitySystemComponent();
-    UAbilitySystemComponent* SourceAbilitySystemComponent = ExecutionParams.GetSourceAbilitySystemComponent();
-
-    AActor* SourceActor = SourceAbilitySystemComponent ? SourceAbilitySystemComponent->AvatarActor : nullptr;
-    AActor* TargetActor = TargetAbilitySystemComponent ? TargetAbilitySystemComponent->AvatarActor : nullptr;
-
-    //Warning: it's non-static. Be careful when modify the GE
-    FGameplayEffectSpec* Spec = ExecutionParams.GetOwningSpecForPreExecuteMod();
+    const FSoulExecutionContext Context(ExecutionParams);
 
-    // Gather the tags from the source and target as that can affect which buffs should be used
-    const FGameplayTagContainer* SourceTags = Spec->CapturedSourceTags.GetAggregatedTags();
-    const FGameplayTagContainer* TargetTags = Spec->CapturedTargetTags.GetAggregatedTags();
-
-    FAggregatorEvaluateParameters EvaluationParameters;
-    EvaluationParameters.SourceTags = SourceTags;
-    EvaluationParameters.TargetTags = TargetTags;
-
-    // --------------------------------------
-    //	Damage Done = (Damage + AP) * (bCritical ? (1 + CriticalMulti ; 1) - DP
-    // --------------------------------------
-
-    float DefensePower = 0.f;
-    ExecutionParams.AttemptCalculateCapturedAttributeMagnitude(DamageStatics().DefensePowerDef, EvaluationParameters,
-                                                               DefensePower);
-    float PostureStrength = 0.f;
-    ExecutionParams.AttemptCalculateCapturedAttributeMagnitude(DamageStatics().PostureStrengthDef, EvaluationParameters,
-                                                               PostureStrength);
-
-    float DamageMulti = 0.f;
-    ExecutionParams.AttemptCalculateCapturedAttributeMagnitude(DamageStatics().DamageDef, EvaluationParameters,
-                                                               DamageMulti);
-    float AttackPower = 0.f;
-    ExecutionParams.AttemptCalculateCapturedAttributeMagnitude(DamageStatics().AttackPowerDef, EvaluationParameters,
-                                                               AttackPower);
-    float CriticalStrike = 0.f;
-    ExecutionParams.AttemptCalculateCapturedAttributeMagnitude(DamageStatics().CriticalStrikeDef, EvaluationParameters,
-                                                               CriticalStrike);
-    float CriticalMulti = 0.f;
-    ExecutionParams.AttemptCalculateCapturedAttributeMagnitude(DamageStatics().CriticalMultiDef, EvaluationParameters,
-                                                               CriticalMulti);
-
-    float PostureMulti = 0.f;
-    ExecutionParams.AttemptCalculateCapturedAttributeMagnitude(DamageStatics().PostureDamageDef, EvaluationParameters,
-                                                               PostureMulti);
-    float PostureCrumble = 0.f;
-    ExecutionParams.AttemptCalculateCapturedAttributeMagnitude(DamageStatics().PostureCrumbleDef, EvaluationParameters,
-                                                               PostureCrumble);
+    TSoulDamageCapture<FSoulReflectionDamagePolicy> Capture;
+    Capture.Evaluate(ExecutionParams, Context.EvaluationParameters);
 
     //HEALTH DAMAGE
-    float DamageDone = (DamageMulti + 1.f) * AttackPower;
-
-    //Defense calculation
-    DamageDone *= (DamageDone / (DamageDone + DefensePower));
+    float DamageDone = ApplyDefense(Capture, CalcBaseDamage(Capture));
 
     //POSTURE DAMAGE
-    const float PostureCrumbleFinal = PostureCrumble + 10.f;
-    float PostureDamageDone = (1.f + PostureMulti) * PostureCrumbleFinal * (PostureCrumbleFinal / (PostureCrumbleFinal +
-        PostureStrength));
+    float PostureDamageDone = CalcPostureDamage(Capture);
 
     //If source actor is perfectly parrying -> reflect 1x damage and posture damage and proc stun
     //If normal parrying -> reflect .4x
     //else .25x
-    if (SourceTags->HasTagExact(FGameplayTag::RequestGameplayTag(FName{"Buffer.Parry.Perfect"}, true)))
+    const uint32 SourceState = GetCombatState(Context.SourceActor, Context.SourceTags);
+    if (SourceState & ESoulCombatState::ParryPerfect)
     {
-        Spec->DynamicAssetTags.AddTagFast(FGameplayTag::RequestGameplayTag(FName{"Damage.Stun"}, true));
+        Context.Spec->DynamicAssetTags.AddTagFast(FSoulGameplayTags::Get().Damage_Stun);
 
     }
-    else if (SourceTags->HasTagExact(FGameplayTag::RequestGameplayTag(FName{"Buffer.Parry.Normal"}, true)))
+    else if (SourceState & ESoulCombatState::ParryNormal)
     {
         PostureDamageDone *= .4f;
         DamageDone *= .4f;
@@ -158,11 +273,7 @@ void USoulReflectionDamageExecution::Execute_Implementation(
         DamageDone *= .25f;
     }
 
-    //Passed the critical tag to the gameplay effect spec
-    //We shall see that when the change of the Damage is passed to the target's AttriuteSet
-
-    (Cast<ASoulCharacterBase>(SourceActor))->
-       Notify_OnMeleeAttack(TargetActor, Spec->GetContext().GetHitResult() ? *(Spec->GetContext().GetHitResult()) : FHitResult());
+    NotifyMeleeAttack(Context);
 
     OutExecutionOutput.AddOutputModifier(
         FGameplayModifierEvaluatedData(DamageStatics().DamageProperty, EGameplayModOp::Additive, DamageDone));
@@ -173,124 +284,75 @@ void USoulReflectionDamageExecution::Execute_Implementation(
 
 USoulDotDamageExecution::USoulDotDamageExecution()
 {
-    RelevantAttributesToCapture.Add(DamageStatics().DamageDef);
-    RelevantAttributesToCapture.Add(DamageStatics().AttackPowerDef);
+    TSoulDamageCapture<FSoulDotDamagePolicy>::AddRelevantAttributes(RelevantAttributesToCapture);
 }
 
 void USoulDamageExecution::Execute_Implementation(const FGameplayEffectCustomExecutionParameters& ExecutionParams,
                                                   OUT FGameplayEffectCustomExecutionOutput& OutExecutionOutput) const
 {
-    UAbilitySystemComponent* TargetAbilitySystemComponent = ExecutionParams.GetTargetAbilitySystemComponent();
-    UAbilitySystemComponent* SourceAbilitySystemComponent = ExecutionParams.GetSourceAbilitySystemComponent();
-
-    AActor* SourceActor = SourceAbilitySystemComponent ? SourceAbilitySystemComponent->AvatarActor : nullptr;
-    AActor* TargetActor = TargetAbilitySystemComponent ? TargetAbilitySystemComponent->AvatarActor : nullptr;
-
-    //Warning: it's non-static. Be careful when modify the GE
-    FGameplayEffectSpec* Spec = ExecutionParams.GetOwningSpecForPreExecuteMod();
-
-    // Gather the tags from the source and target as that can affect which buffs should be used
-    const FGameplayTagContainer* SourceTags = Spec->CapturedSourceTags.GetAggregatedTags();
-    const FGameplayTagContainer* TargetTags = Spec->CapturedTargetTags.GetAggregatedTags();
+    const FSoulExecutionContext Context(ExecutionParams);
+    FGameplayEffectSpec* Spec = Context.Spec;
 
-    FAggregatorEvaluateParameters EvaluationParameters;
-    EvaluationParameters.SourceTags = SourceTags;
-    EvaluationParameters.TargetTags = TargetTags;
-
-    // --------------------------------------
-    //	Damage Done = (Damage + AP) * (bCritical ? (1 + CriticalMulti ; 1) - DP
-    // --------------------------------------
-
-    float DefensePower = 0.f;
-    ExecutionParams.AttemptCalculateCapturedAttributeMagnitude(DamageStatics().DefensePowerDef, EvaluationParameters,
-                                                               DefensePower);
-    float PostureStrength = 0.f;
-    ExecutionParams.AttemptCalculateCapturedAttributeMagnitude(DamageStatics().PostureStrengthDef, EvaluationParameters,
-                                                               PostureStrength);
-
-    float DamageMulti = 0.f;
-    ExecutionParams.AttemptCalculateCapturedAttributeMagnitude(DamageStatics().DamageDef, EvaluationParameters,
-                                                               DamageMulti);
-    float AttackPower = 0.f;
-    ExecutionParams.AttemptCalculateCapturedAttributeMagnitude(DamageStatics().AttackPowerDef, EvaluationParameters,
-                                                               AttackPower);
-    float CriticalStrike = 0.f;
-    ExecutionParams.AttemptCalculateCapturedAttributeMagnitude(DamageStatics().CriticalStrikeDef, EvaluationParameters,
-                                                               CriticalStrike);
-    float CriticalMulti = 0.f;
-    ExecutionParams.AttemptCalculateCapturedAttributeMagnitude(DamageStatics().CriticalMultiDef, EvaluationParameters,
-                                                               CriticalMulti);
-
-    float PostureMulti = 0.f;
-    ExecutionParams.AttemptCalculateCapturedAttributeMagnitude(DamageStatics().PostureDamageDef, EvaluationParameters,
-                                                               PostureMulti);
-    float PostureCrumble = 0.f;
-    ExecutionParams.AttemptCalculateCapturedAttributeMagnitude(DamageStatics().PostureCrumbleDef, EvaluationParameters,
-                                                               PostureCrumble);
+    TSoulDamageCapture<FSoulMeleeDamagePolicy> Capture;
+    Capture.Evaluate(ExecutionParams, Context.EvaluationParameters);
 
     //Check whether it's a crit strike from source
     //TODO: "Can't crit" tag to prevent crit triggered
     const int32 TempCritRoll = FMath::RandRange(0, 100);
-    const bool bIsCrit = CriticalStrike >= TempCritRoll ? true : false;
 
     //HEALTH DAMAGE
-    float DamageDone = (DamageMulti + 1.f) * AttackPower;
+    float DamageDone = CalcBaseDamage(Capture);
 
-    if (CriticalStrike >= TempCritRoll)
+    if (Capture.Get<ESoulDamageAttribute::CriticalStrike>() >= TempCritRoll)
     {
-        Spec->DynamicAssetTags.AddTagFast(FGameplayTag::RequestGameplayTag(FName{"Damage.Critical"}, true));
-        DamageDone *=  (1 + CriticalMulti / 100.f);
+        Spec->DynamicAssetTags.AddTagFast(FSoulGameplayTags::Get().Damage_Critical);
+        DamageDone *=  (1 + Capture.Get<ESoulDamageAttribute::CriticalMulti>() / 100.f);
     }
 
     //Defense calculation
-    DamageDone *= (DamageDone / (DamageDone + DefensePower));
+    DamageDone = ApplyDefense(Capture, DamageDone);
 
     //POSTURE DAMAGE
-    const float PostureCrumbleFinal = PostureCrumble + 10.f;
-    float PostureDamageDone = (1.f + PostureMulti) * PostureCrumbleFinal * (PostureCrumbleFinal / (PostureCrumbleFinal +
-        PostureStrength));
+    float PostureDamageDone = CalcPostureDamage(Capture);
 
 
     float CuttingAngle = 0.f;
-    UBPFL_Math::FindDegreeToTarget(TargetActor, SourceActor, CuttingAngle);
+    UBPFL_Math::FindDegreeToTarget(Context.TargetActor, Context.SourceActor, CuttingAngle);
     //GEngine->AddOnScreenDebugMessage(-1, 5, FColor::Red, FString::SanitizeFloat(CuttingAngle));
 
-    if (TargetTags->HasTag(FGameplayTag::RequestGameplayTag(FName{"Buffer.Parry"}, true)) && FMath::Abs(CuttingAngle) <
+    const uint32 TargetState = GetCombatState(Context.TargetActor, Context.TargetTags);
+    if ((TargetState & ESoulCombatState::Parry) && FMath::Abs(CuttingAngle) <
         90.f)
     {
-        if (TargetTags->HasTagExact(FGameplayTag::RequestGameplayTag(FName{"Buffer.Parry.Perfect"}, true)))
+        if (TargetState & ESoulCombatState::ParryPerfect)
         {
             //Warning: Pass the tag through the GE, just in case the Parry's GA ends before the Notify_OnMeleeAttack is triggered;
-            Spec->DynamicAssetTags.AddTagFast(FGameplayTag::RequestGameplayTag(FName{"Buffer.Parry.Perfect"}, true));
+            Spec->DynamicAssetTags.AddTagFast(FSoulGameplayTags::Get().Buffer_Parry_Perfect);
 
             PostureDamageDone = DamageDone = 0.f;
         }
-        else if (TargetTags->HasTagExact(FGameplayTag::RequestGameplayTag(FName{"Buffer.Parry.Normal"}, true)))
+        else if (TargetState & ESoulCombatState::ParryNormal)
         {
-            Spec->DynamicAssetTags.AddTagFast(FGameplayTag::RequestGameplayTag(FName{"Buffer.Parry.Normal"}, true));
+            Spec->DynamicAssetTags.AddTagFast(FSoulGameplayTags::Get().Buffer_Parry_Normal);
 
             DamageDone *= 0.25f;
             PostureDamageDone *= .25f;
         }
     }
-    else if (TargetTags->HasTagExact(FGameplayTag::RequestGameplayTag(FName{"Buffer.Dodge"}, true)))
+    else if (TargetState & ESoulCombatState::Dodge)
     {
         //GEngine->AddOnScreenDebugMessage(-1, 5, FColor::Red, "Buffer.Dodge");
 
-        Spec->DynamicAssetTags.AddTagFast(FGameplayTag::RequestGameplayTag(FName{"Buffer.Dodge"}, true));
+        Spec->DynamicAssetTags.AddTagFast(FSoulGameplayTags::Get().Buffer_Dodge);
 
         PostureDamageDone = DamageDone = 0.f;
     }
-    else if (!Spec->DynamicAssetTags.HasTagExact(FGameplayTag::RequestGameplayTag(FName{"Damage.Stun"}, true)))
+    else if (!Spec->DynamicAssetTags.HasTagExact(FSoulGameplayTags::Get().Damage_Stun))
     {
-        Spec->DynamicAssetTags.AddTagFast(FGameplayTag::RequestGameplayTag(FName{"Damage.Stun"}, true));
+        Spec->DynamicAssetTags.AddTagFast(FSoulGameplayTags::Get().Damage_Stun);
     }
 
-    //Passed the critical tag to the gameplay effect spec
-    //We shall see that when the change of the Damage is passed to the target's AttriuteSet
-
-    (Cast<ASoulCharacterBase>(SourceActor))->
-       Notify_OnMeleeAttack(TargetActor, Spec->GetContext().GetHitResult() ? *(Spec->GetContext().GetHitResult()) : FHitResult());
+    NotifyMeleeAttack(Context);
 
     OutExecutionOutput.AddOutputModifier(
         FGameplayModifierEvaluatedData(DamageStatics().DamageProperty, EGameplayModOp::Additive, DamageDone));
@@ -304,39 +366,12 @@ void USoulDamageExecution::Execute_Implementation(const FGameplayEffectCustomExe
 void USoulDotDamageExecution::Execute_Implementation(const FGameplayEffectCustomExecutionParameters& ExecutionParams,
                                                      OUT FGameplayEffectCustomExecutionOutput& OutExecutionOutput) const
 {
-    UAbilitySystemComponent* TargetAbilitySystemComponent = ExecutionParams.GetTargetAbilitySystemComponent();
-    UAbilitySystemComponent* SourceAbilitySystemComponent = ExecutionParams.GetSourceAbilitySystemComponent();
-
-    AActor* SourceActor = SourceAbilitySystemComponent ? SourceAbilitySystemComponent->AvatarActor : nullptr;
-    AActor* TargetActor = TargetAbilitySystemComponent ? TargetAbilitySystemComponent->AvatarActor : nullptr;
-
-
-    //Warning: it's non-static. Be careful when modify the GE
-    FGameplayEffectSpec* Spec = ExecutionParams.GetOwningSpecForPreExecuteMod();
-
-    // Gather the tags from the source and target as that can affect which buffs should be used
-    const FGameplayTagContainer* SourceTags = Spec->CapturedSourceTags.GetAggregatedTags();
-    const FGameplayTagContainer* TargetTags = Spec->CapturedTargetTags.GetAggregatedTags();
-
-    FAggregatorEvaluateParameters EvaluationParameters;
-    EvaluationParameters.SourceTags = SourceTags;
-    EvaluationParameters.TargetTags = TargetTags;
-
-    float DefensePower = 0.f;
-    ExecutionParams.AttemptCalculateCapturedAttributeMagnitude(DamageStatics().DefensePowerDef, EvaluationParameters,
-                                                               DefensePower);
-
-    float DamageMulti = 0.f;
-    ExecutionParams.AttemptCalculateCapturedAttributeMagnitude(DamageStatics().DamageDef, EvaluationParameters,
-                                                               DamageMulti);
-    float AttackPower = 0.f;
-    ExecutionParams.AttemptCalculateCapturedAttributeMagnitude(DamageStatics().AttackPowerDef, EvaluationParameters,
-                                                               AttackPower);
+    const FSoulExecutionContext Context(ExecutionParams);
 
-    float DamageDone = 0.f;
-    DamageDone = (DamageMulti + 1.f) * AttackPower;
+    TSoulDamageCapture<FSoulDotDamagePolicy> Capture;
+    Capture.Evaluate(ExecutionParams, Context.EvaluationParameters);
 
-    DamageDone *= (DamageDone / (DamageDone + DefensePower));
+    const float DamageDone = ApplyDefense(Capture, CalcBaseDamage(Capture));
 
     if (DamageDone >= 0.f)
     {
@@ -2,14 +2,15 @@
 
 
 #include "BPFL/BPFL_GameplayTag.h"
+#include "Types/SoulGameplayTags.h"
 
 void UBPFL_GameplayTag::IsCharacterParry(const UAbilitySystemComponent* ASC, EParryStatus& ParryResult)
 {
     if (ASC)
     {
-        if (ASC->HasMatchingGameplayTag(FGameplayTag::RequestGameplayTag("Buffer.Parry.Perfect", true)))
+        if (ASC->HasMatchingGameplayTag(FSoulGameplayTags::Get().Buffer_Parry_Perfect))
             ParryResult = EParryStatus::Perfect;
-        else if (ASC->HasMatchingGameplayTag(FGameplayTag::RequestGameplayTag("Buffer.Parry.Normal", true)))
+        else if (ASC->HasMatchingGameplayTag(FSoulGameplayTags::Get().Buffer_Parry_Normal))
             ParryResult = EParryStatus::Normal;
 
         return;
@@ -0,0 +1,179 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Item/MeleeHitSubsystem.h"
+#include "Item/WeaponActor.h"
+#include "Engine/World.h"
+
+void FMeleeTraceBatch::AddWeapon(AWeaponActor* Weapon, const FCollisionShape& Shape)
+{
+    Weapons.Add(Weapon);
+    SwingSerials.Add(Weapon->GetSwingSerial());
+    Shapes.Add(Shape);
+    FirstSegments.Add(Starts.Num());
+    NumSegments.Add(0);
+}
+
+void FMeleeTraceBatch::AddSegment(const FVector& Start, const FVector& End, const FQuat& Rotation)
+{
+    Starts.Add(Start);
+    Ends.Add(End);
+    Rotations.Add(Rotation);
+    NumSegments.Last()++;
+}
+
+void FMeleeTraceBatch::Reset()
+{
+    Starts.Reset();
+    Ends.Reset();
+    Rotations.Reset();
+    Handles.Reset();
+
+    Weapons.Reset();
+    SwingSerials.Reset();
+    Shapes.Reset();
+    FirstSegments.Reset();
+    NumSegments.Reset();
+}
+
+void UMeleeHitSubsystem::RegisterWeapon(AWeaponActor* Weapon)
+{
+    ActiveWeapons.AddUnique(Weapon);
+}
+
+void UMeleeHitSubsystem::UnregisterWeapon(AWeaponActor* Weapon)
+{
+    // Traces already issued for the weapon are still resolved, since they belong to the swing being ended
+    if (!bIsTicking)
+        ActiveWeapons.RemoveSingleSwap(Weapon);
+}
+
+void UMeleeHitSubsystem::ResolveWeapon(AWeaponActor* Weapon)
+{
+    for (int32 WeaponIndex = 0; WeaponIndex < Batch.Weapons.Num(); ++WeaponIndex)
+    {
+        if (Batch.Weapons[WeaponIndex].Get() == Weapon)
+            ResolveBatchWeapon(WeaponIndex);
+    }
+}
+
+void UMeleeHitSubsystem::Deinitialize()
+{
+    ActiveWeapons.Reset();
+    Batch.Reset();
+
+    Super::Deinitialize();
+}
+
+void UMeleeHitSubsystem::Tick(float DeltaTime)
+{
+    TGuardValue<bool> TickingGuard(bIsTicking, true);
+
+    ResolveBatch();
+
+    Batch.Reset();
+    for (int32 i = ActiveWeapons.Num() - 1; i >= 0; --i)
+    {
+        AWeaponActor* Weapon = ActiveWeapons[i].Get();
+        if (!Weapon || !Weapon->GetIsSwinging())
+        {
+            ActiveWeapons.RemoveAtSwap(i);
+            continue;
+        }
+
+        if (Weapon->NeedsSynchronousTrace())
+            Weapon->CheckCollision();
+        else
+            Weapon->AddBladeSegments(Batch);
+    }
+
+    IssueBatch();
+}
+
+void UMeleeHitSubsystem::IssueBatch()
+{
+    UWorld* World = GetWorld();
+
+    Batch.Handles.SetNum(Batch.Starts.Num());
+    for (int32 WeaponIndex = 0; WeaponIndex < Batch.Weapons.Num(); ++WeaponIndex)
+    {
+        // Swings ended while the batch was gathered were already resolved
+        AWeaponActor* Weapon = Batch.Weapons[WeaponIndex].Get();
+        if (!Weapon)
+            continue;
+
+        const FCollisionShape& Shape = Batch.Shapes[WeaponIndex];
+        const FCollisionQueryParams QueryParams = MakeQueryParams(Weapon);
+
+        const int32 EndSegment = Batch.FirstSegments[WeaponIndex] + Batch.NumSegments[WeaponIndex];
+        for (int32 Segment = Batch.FirstSegments[WeaponIndex]; Segment < EndSegment; ++Segment)
+        {
+            Batch.Handles[Segment] = Shape.IsLine()
+                ? World->AsyncLineTraceByChannel(EAsyncTraceType::Multi, Batch.Starts[Segment], Batch.Ends[Segment], ECC_Pawn, QueryParams)
+                : World->AsyncSweepByChannel(EAsyncTraceType::Multi, Batch.Starts[Segment], Batch.Ends[Segment], Batch.Rotations[Segment], ECC_Pawn, Shape, QueryParams);
+        }
+    }
+}
+
+void UMeleeHitSubsystem::ResolveBatch()
+{
+    for (int32 WeaponIndex = 0; WeaponIndex < Batch.Weapons.Num(); ++WeaponIndex)
+    {
+        ResolveBatchWeapon(WeaponIndex);
+    }
+}
+
+void UMeleeHitSubsystem::ResolveBatchWeapon(int32 WeaponIndex)
+{
+    // Hits of a previous swing must not count for the current one
+    AWeaponActor* Weapon = Batch.Weapons[WeaponIndex].Get();
+
+    // Each entry is resolved once. It is kept in place, so that indices stay valid if hits end a swing meanwhile
+    Batch.Weapons[WeaponIndex].Reset();
+
+    if (!Weapon || Weapon->GetSwingSerial() != Batch.SwingSerials[WeaponIndex])
+        return;
+
+    UWorld* World = GetWorld();
+    const FCollisionShape& Shape = Batch.Shapes[WeaponIndex];
+
+    FTraceDatum TraceDatum;
+    TArray<FHitResult> WeaponHits;
+    const int32 EndSegment = Batch.FirstSegments[WeaponIndex] + Batch.NumSegments[WeaponIndex];
+    for (int32 Segment = Batch.FirstSegments[WeaponIndex]; Segment < EndSegment; ++Segment)
+    {
+        if (Batch.Handles.IsValidIndex(Segment) && World->QueryTraceData(Batch.Handles[Segment], TraceDatum))
+        {
+            WeaponHits.Append(TraceDatum.OutHits);
+            continue;
+        }
+
+        // Traces issued this frame only finish at its end, and those of a batch still being gathered are not issued yet
+        TArray<FHitResult> SegmentHits;
+        if (Shape.IsLine())
+            World->LineTraceMultiByChannel(SegmentHits, Batch.Starts[Segment], Batch.Ends[Segment], ECC_Pawn, MakeQueryParams(Weapon));
+        else
+            World->SweepMultiByChannel(SegmentHits, Batch.Starts[Segment], Batch.Ends[Segment], Batch.Rotations[Segment], ECC_Pawn, Shape, MakeQueryParams(Weapon));
+        WeaponHits.Append(SegmentHits);
+    }
+
+    if (WeaponHits.Num() > 0)
+        Weapon->ApplyHits(WeaponHits);
+}
+
+FCollisionQueryParams UMeleeHitSubsystem::MakeQueryParams(const AWeaponActor* Weapon)
+{
+    FCollisionQueryParams QueryParams;
+    QueryParams.AddIgnoredActor(Weapon);
+    QueryParams.AddIgnoredActor(Weapon->GetInstigator());
+    return QueryParams;
+}
+
+bool UMeleeHitSubsystem::IsTickable() const
+{
+    return !HasAnyFlags(RF_ClassDefaultObject) && (ActiveWeapons.Num() > 0 || Batch.Weapons.Num() > 0);
+}
+
+TStatId UMeleeHitSubsystem::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(UMeleeHitSubsystem, STATGROUP_Tickables);
+}
@@ -1,21 +1,34 @@
 // Fill out your copyright notice in the Description page of Project Settings.
 
 #include "Item/WeaponActor.h"
+#include "Item/MeleeHitSubsystem.h"
+#include "Soul_Like_ACT.h"
 #include "Components/SkeletalMeshComponent.h"
+#include "Components/StaticMeshComponent.h"
+#include "Engine/CollisionProfile.h"
 #include "Kismet/GameplayStatics.h"
 #include "Abilities/SoulAbilitySysBPLib.h"
 #include "SoulCharacterBase.h"
 #include "DrawDebugHelpers.h"
+#include "HAL/IConsoleManager.h"
 
+static TAutoConsoleVariable<int32> CVarWeaponTraceParity(
+    TEXT("Soul.WeaponTraceParity"),
+    0,
+    TEXT("If non-zero, weapons also trace with the mode they do not use, and log targets hit by only one of the modes and trace counts per swing."));
 
 // Sets default values
 AWeaponActor::AWeaponActor()
 {
-    // Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
-    PrimaryActorTick.bCanEverTick = true;
+    // Blades are traced by UMeleeHitSubsystem while swinging
+    PrimaryActorTick.bCanEverTick = false;
 
     MeshComp = CreateDefaultSubobject<USkeletalMeshComponent>("MeshComp");
     MeshComp->SetupAttachment(RootComponent);
+
+    StaticMeshComp = CreateDefaultSubobject<UStaticMeshComponent>("StaticMeshComp");
+    StaticMeshComp->SetupAttachment(MeshComp);
+    StaticMeshComp->SetCollisionProfileName(UCollisionProfile::NoCollision_ProfileName);
 }
 
 // Called when the game starts or when spawned
@@ -27,22 +40,202 @@ void AWeaponActor::BeginPlay()
     
     check(OwnerRef);
     check(GearInfo);
+
+    // Rigid weapons skip skeletal mesh updates entirely
+    if (GearInfo->IsRigid())
+    {
+        StaticMeshComp->SetStaticMesh(GearInfo->StaticWeaponMesh);
+        MeshComp->SetSkeletalMesh(nullptr);
+        MeshComp->SetComponentTickEnabled(false);
+    }
+}
+
+void AWeaponActor::CheckCollision(bool bFlush)
+{
+    const FTransform CurrBladeTransform = GetActorTransform();
+    const int32 NumSubsteps = GetNumSubsteps(CurrBladeTransform, bFlush);
+    if (NumSubsteps == 0)
+        return;
+
+    TArray<FHitResult> Hits;
+    SwingTraceCount += TraceBlade(GearInfo->TraceMode, CurrBladeTransform, NumSubsteps, Hits, bEnableDrawTraceLine);
+
+    if (CVarWeaponTraceParity.GetValueOnGameThread())
+    {
+        CheckTraceParity(GearInfo->TraceMode, CurrBladeTransform, NumSubsteps, Hits);
+    }
+
+    PrevBladeTransform = CurrBladeTransform;
+
+    ApplyHits(Hits);
+}
+
+void AWeaponActor::AddBladeSegments(FMeleeTraceBatch& Batch)
+{
+    const FTransform CurrBladeTransform = GetActorTransform();
+    const int32 NumSubsteps = GetNumSubsteps(CurrBladeTransform, false);
+    if (NumSubsteps == 0)
+        return;
+
+    Batch.AddWeapon(this, GetBladeShape(GearInfo->TraceMode));
+    ForEachBladeSegment(GearInfo->TraceMode, CurrBladeTransform, NumSubsteps, [this, &Batch](const FVector& Start, const FVector& End, const FQuat& Rotation)
+    {
+        Batch.AddSegment(Start, End, Rotation);
+        SwingTraceCount++;
+    });
+
+    PrevBladeTransform = CurrBladeTransform;
+}
+
+bool AWeaponActor::NeedsSynchronousTrace() const
+{
+    return bEnableDrawTraceLine || CVarWeaponTraceParity.GetValueOnGameThread() != 0;
+}
+
+FVector AWeaponActor::GetBladePoint(const FTransform& BladeTransform, float Length)
+{
+    return BladeTransform.GetLocation() + Length * BladeTransform.GetRotation().GetUpVector();
+}
+
+int32 AWeaponActor::GetNumSubsteps(const FTransform& CurrBladeTransform, bool bFlush) const
+{
+    // Slow blades accumulate movement over frames instead of tracing tiny steps
+    const float TipDistance = FVector::Dist(GetBladePoint(PrevBladeTransform, GearInfo->BladeTail), GetBladePoint(CurrBladeTransform, GearInfo->BladeTail));
+    if (TipDistance <= 0.f || (TipDistance < GearInfo->MinTraceDistance && !bFlush))
+        return 0;
+
+    // Fast blades are traced in substeps, so that they do not pass through thin targets at low frame rates
+    return FMath::Clamp(FMath::CeilToInt(TipDistance / FMath::Max(GearInfo->MaxSubstepDistance, 1.f)), 1, FMath::Max(GearInfo->MaxSubsteps, 1));
+}
+
+void AWeaponActor::TransformBladePoints(const FTransform& BladeTransform, TArray<FVector, TInlineAllocator<16>>& OutPoints) const
+{
+    // One matrix for all the points, without scale like GetBladePoint
+    const FMatrix BladeMatrix = BladeTransform.ToMatrixNoScale();
+    const TArray<FVector>& LocalPoints = GearInfo->BladeSamplePoints;
+
+    OutPoints.SetNumUninitialized(LocalPoints.Num(), false);
+    for (int32 i = 0; i < LocalPoints.Num(); i++)
+    {
+        OutPoints[i] = BladeMatrix.TransformPosition(LocalPoints[i]);
+    }
+}
+
+FCollisionShape AWeaponActor::GetBladeShape(EWeaponTraceMode TraceMode) const
+{
+    // Both shapes are aligned with Z, which is the blade direction of the actor
+    const float Radius = GearInfo->BladeRadius;
+    const float HalfLength = FMath::Max((GearInfo->BladeTail - GearInfo->BladeStartLength) * 0.5f, Radius);
+
+    switch (TraceMode)
+    {
+    case EWeaponTraceMode::VE_CapsuleSweep:
+        return FCollisionShape::MakeCapsule(Radius, HalfLength);
+    case EWeaponTraceMode::VE_BoxSweep:
+        return FCollisionShape::MakeBox(FVector(Radius, Radius, HalfLength));
+    default:
+        return FCollisionShape();
+    }
+}
+
+void AWeaponActor::ForEachBladeSegment(EWeaponTraceMode TraceMode, const FTransform& CurrBladeTransform, int32 NumSubsteps,
+    TFunctionRef<void(const FVector&, const FVector&, const FQuat&)> Function) const
+{
+    const float CenterLength = (GearInfo->BladeStartLength + GearInfo->BladeTail) * 0.5f;
+
+    // A sweep holds one rotation, halfway through its turn. The blade ends then stray by 2 * HalfLength * sin(Angle / 4)
+    // from the real poses at the sweep ends, which stays within the blade radius below this angle
+    const float HalfLength = FMath::Max((GearInfo->BladeTail - GearInfo->BladeStartLength) * 0.5f, GearInfo->BladeRadius);
+    const float MaxSweepAngle = HalfLength > 0.f ? 4.f * FMath::Asin(FMath::Min(GearInfo->BladeRadius / (2.f * HalfLength), 1.f)) : PI;
+
+    TArray<FVector, TInlineAllocator<16>> StartPoints;
+    TArray<FVector, TInlineAllocator<16>> EndPoints;
+
+    // Blade transforms between frames are interpolated
+    FTransform StepStart = PrevBladeTransform;
+    for (int32 Step = 1; Step <= NumSubsteps; Step++)
+    {
+        FTransform StepEnd = CurrBladeTransform;
+        if (Step < NumSubsteps)
+            StepEnd.Blend(PrevBladeTransform, CurrBladeTransform, (float)Step / NumSubsteps);
+
+        if (TraceMode != EWeaponTraceMode::VE_LineSamples)
+        {
+            // The actor pivots at the hilt, so swings are mostly rotation: split the step by the angle it turns
+            const float StepAngle = StepStart.GetRotation().AngularDistance(StepEnd.GetRotation());
+            const int32 NumSweeps = FMath::Clamp(FMath::CeilToInt(StepAngle / FMath::Max(MaxSweepAngle, KINDA_SMALL_NUMBER)), 1,
+                                                 FMath::Max(GearInfo->MaxSweepsPerSubstep, 1));
+
+            FTransform SweepStart = StepStart;
+            for (int32 Sweep = 1; Sweep <= NumSweeps; Sweep++)
+            {
+                FTransform SweepEnd = StepEnd;
+                if (Sweep < NumSweeps)
+                    SweepEnd.Blend(StepStart, StepEnd, (float)Sweep / NumSweeps);
+
+                Function(GetBladePoint(SweepStart, CenterLength), GetBladePoint(SweepEnd, CenterLength),
+                         FQuat::Slerp(SweepStart.GetRotation(), SweepEnd.GetRotation(), 0.5f));
+
+                SweepStart = SweepEnd;
+            }
+        }
+        else
+        {
+            // Sample points of the step start are those of the previous step end
+            if (Step == 1)
+                TransformBladePoints(StepStart, StartPoints);
+            else
+                Swap(StartPoints, EndPoints);
+            TransformBladePoints(StepEnd, EndPoints);
+
+            for (int32 i = 0; i < EndPoints.Num(); i++)
+            {
+                Function(StartPoints[i], EndPoints[i], StepEnd.GetRotation());
+            }
+        }
+
+        StepStart = StepEnd;
+    }
 }
 
-void AWeaponActor::CheckCollision()
+int32 AWeaponActor::TraceBlade(EWeaponTraceMode TraceMode, const FTransform& CurrBladeTransform, int32 NumSubsteps, TArray<FHitResult>& OutHits, bool bDrawTrace) const
 {
-    PrevVecs = CurrVecs;
-    for (int i = GearInfo->BladeStartLength; i <= GearInfo->BladeTail; i += 20)
+    const FCollisionShape Shape = GetBladeShape(TraceMode);
+
+    int32 TraceCount = 0;
+    ForEachBladeSegment(TraceMode, CurrBladeTransform, NumSubsteps, [this, &Shape, &OutHits, bDrawTrace, &TraceCount](const FVector& Start, const FVector& End, const FQuat& Rotation)
     {
-        const int32 size_ = (i - GearInfo->BladeStartLength) / 10;
+        if (Shape.IsLine())
+            DrawTraceLine(Start, End, bDrawTrace, OutHits);
+        else
+            SweepBlade(Shape, Start, End, Rotation, OutHits, bDrawTrace);
+        TraceCount++;
+    });
+    return TraceCount;
+}
 
-        CurrVecs[size_] = GetActorLocation() + i * GetActorUpVector();
+void AWeaponActor::SweepBlade(const FCollisionShape& Shape, const FVector& Start, const FVector& End, const FQuat& Rotation, TArray<FHitResult>& OutHits, bool bDrawTrace) const
+{
+    FCollisionQueryParams QueryParams;
+    QueryParams.AddIgnoredActor(this);
+    QueryParams.AddIgnoredActor(OwnerRef);
+
+    TArray<FHitResult> Hits;
+    const bool bIsHit = GetWorld()->SweepMultiByChannel(Hits, Start, End, Rotation, ECC_Pawn, Shape, QueryParams);
+    OutHits.Append(Hits);
 
-        DrawTraceLine(PrevVecs[size_], CurrVecs[size_], bEnableDrawTraceLine);
+    if (bDrawTrace)
+    {
+        const FColor Color = bIsHit ? FColor::Green : FColor::Red;
+        if (Shape.IsBox())
+            DrawDebugBox(GetWorld(), End, Shape.GetExtent(), Rotation, Color, 0, 2.f, 0, 1.f);
+        else
+            DrawDebugCapsule(GetWorld(), End, Shape.GetCapsuleHalfHeight(), Shape.GetCapsuleRadius(), Rotation, Color, 0, 2.f, 0, 1.f);
+        DrawDebugLine(GetWorld(), Start, End, Color, 0, 2.f, 0, 1.f);
     }
 }
 
-void AWeaponActor::DrawTraceLine(FVector prevVec_, FVector currVec_, bool bDrawTraceLine)
+void AWeaponActor::DrawTraceLine(FVector prevVec_, FVector currVec_, bool bDrawTraceLine, TArray<FHitResult>& OutHits) const
 {
     TArray<FHitResult> Hits;
     FCollisionQueryParams QueryParams;
@@ -55,33 +248,85 @@ void AWeaponActor::DrawTraceLine(FVector prevVec_, FVector currVec_, bool bDrawT
         if (bDrawTraceLine)
             DrawDebugLine(GetWorld(), prevVec_, currVec_, FColor::Green, 0, 2.f, 0, 1.f);
 
-        for (const auto& Hit : Hits)
-        {
-            ASoulCharacterBase* TargetPawn = Cast<ASoulCharacterBase>(Hit.GetActor());
-            if (TargetPawn
-                && ASoulCharacterBase::IsInRivalFaction(OwnerRef, TargetPawn)
-                && TryExcludeActor(TargetPawn))
-            {
-                ApplyEventBackToGA(TargetPawn, Hit);
-            }
-        }
+        OutHits.Append(Hits);
     }
     else if (bDrawTraceLine)
         DrawDebugLine(GetWorld(), prevVec_, currVec_, FColor::Red, 0, 2.f, 0, 1.f);
 }
 
+void AWeaponActor::ApplyHits(const TArray<FHitResult>& Hits)
+{
+    for (const auto& Hit : Hits)
+    {
+        ASoulCharacterBase* TargetPawn = Cast<ASoulCharacterBase>(Hit.GetActor());
+        if (TargetPawn
+            && ASoulCharacterBase::IsInRivalFaction(OwnerRef, TargetPawn)
+            && TryExcludeActor(TargetPawn))
+        {
+            ApplyEventBackToGA(TargetPawn, Hit);
+        }
+    }
+}
+
+/*
+* Collect rivals which would take the impact, without excluding them
+*/
+void AWeaponActor::CollectRivalTargets(const TArray<FHitResult>& Hits, TArray<AActor*>& OutTargets) const
+{
+    for (const auto& Hit : Hits)
+    {
+        ASoulCharacterBase* TargetPawn = Cast<ASoulCharacterBase>(Hit.GetActor());
+        if (TargetPawn
+            && ASoulCharacterBase::IsInRivalFaction(OwnerRef, TargetPawn)
+            && !MyTargets.Contains(TargetPawn))
+        {
+            OutTargets.AddUnique(TargetPawn);
+        }
+    }
+}
+
+/*
+* Trace with line samples if sweeping, or with a capsule if sampling, and log targets only one of them hits
+*/
+void AWeaponActor::CheckTraceParity(EWeaponTraceMode TraceMode, const FTransform& CurrBladeTransform, int32 NumSubsteps, const TArray<FHitResult>& Hits)
+{
+    const EWeaponTraceMode ParityMode = TraceMode == EWeaponTraceMode::VE_LineSamples ? EWeaponTraceMode::VE_CapsuleSweep : EWeaponTraceMode::VE_LineSamples;
+
+    TArray<FHitResult> ParityHits;
+    SwingParityTraceCount += TraceBlade(ParityMode, CurrBladeTransform, NumSubsteps, ParityHits, false);
+
+    TArray<AActor*> Targets;
+    TArray<AActor*> ParityTargets;
+    CollectRivalTargets(Hits, Targets);
+    CollectRivalTargets(ParityHits, ParityTargets);
+
+    for (AActor* Target : Targets)
+    {
+        if (!ParityTargets.Contains(Target))
+        {
+            SwingParityMismatches++;
+            UE_LOG(LogTemp, Warning, TEXT("%s: %s is hit by %s only"), *GetName(), *Target->GetName(), *GETENUMSTRING("EWeaponTraceMode", TraceMode));
+        }
+    }
+    for (AActor* Target : ParityTargets)
+    {
+        if (!Targets.Contains(Target))
+        {
+            SwingParityMismatches++;
+            UE_LOG(LogTemp, Warning, TEXT("%s: %s is hit by %s only"), *GetName(), *Target->GetName(), *GETENUMSTRING("EWeaponTraceMode", ParityMode));
+        }
+    }
+}
+
 /*
 * Exclude the actor which takes the impact
 * Return true if the Actor has not been impacted
 */
 bool AWeaponActor::TryExcludeActor(AActor* HitActor)
 {
-    if (MyTargets.Contains(HitActor))
-    {
-        return 0;
-    }
-    MyTargets.Add(HitActor);
-    return 1;
+    bool bIsAlreadyTarget = false;
+    MyTargets.Add(HitActor, &bIsAlreadyTarget);
+    return !bIsAlreadyTarget;
 }
 
 void AWeaponActor::StartSwing(const float& InDmgMulti)
@@ -90,28 +335,44 @@ void AWeaponActor::StartSwing(const float& InDmgMulti)
 
     DmgMultiplier = InDmgMulti;
 
-    CurrVecs.Reset();
-    MyTargets.Empty();
+    MyTargets.Reset();
+
+    SwingSerial++;
+    SwingTraceCount = 0;
+    SwingParityTraceCount = 0;
+    SwingParityMismatches = 0;
 
     if (GearInfo->SwingSound)
         UGameplayStatics::PlaySoundAtLocation(GetWorld(), GearInfo->SwingSound, GetActorLocation());
 
-    for (int i = GearInfo->BladeStartLength; i <= GearInfo->BladeTail; i += 10)
-    {
-        CurrVecs.Add(GetActorLocation() + i * GetActorUpVector());
-    }
-}
+    PrevBladeTransform = GetActorTransform();
 
-void AWeaponActor::EndSwing()
-{
-    bIsTracingCollision = 0;
+    if (UMeleeHitSubsystem* MeleeHitSubsystem = GetWorld()->GetSubsystem<UMeleeHitSubsystem>())
+        MeleeHitSubsystem->RegisterWeapon(this);
 }
 
-// Called every frame
-void AWeaponActor::Tick(float DeltaTime)
+void AWeaponActor::EndSwing()
 {
-    Super::Tick(DeltaTime);
+    UMeleeHitSubsystem* MeleeHitSubsystem = GetWorld()->GetSubsystem<UMeleeHitSubsystem>();
 
     if (bIsTracingCollision)
-        CheckCollision();
+    {
+        // Apply traces still in flight while targets and damage belong to this swing, since a next swing may start this frame
+        if (MeleeHitSubsystem)
+            MeleeHitSubsystem->ResolveWeapon(this);
+
+        // Trace movement accumulated since the last trace
+        CheckCollision(true);
+    }
+
+    if (bIsTracingCollision && CVarWeaponTraceParity.GetValueOnGameThread())
+    {
+        UE_LOG(LogTemp, Warning, TEXT("%s swing: %d traces with %s, %d traces with the other mode, %d targets hit by one mode only"),
+            *GetName(), SwingTraceCount, *GETENUMSTRING("EWeaponTraceMode", GearInfo->TraceMode), SwingParityTraceCount, SwingParityMismatches);
+    }
+
+    bIsTracingCollision = 0;
+
+    if (MeleeHitSubsystem)
+        MeleeHitSubsystem->UnregisterWeapon(this);
 }
@@ -9,6 +9,25 @@
 #include "ActorFxManager.h"
 #include "NavigationSystem.h"
 
+struct FCombatStateTag
+{
+    FGameplayTag Tag;
+    uint32 State;
+};
+
+static const TArray<FCombatStateTag>& GetCombatStateTags()
+{
+    static const TArray<FCombatStateTag> CombatStateTags{
+        {FSoulGameplayTags::Get().Ailment_Dead, ESoulCombatState::Dead},
+        {FSoulGameplayTags::Get().Ailment_Stun, ESoulCombatState::Stun},
+        {FSoulGameplayTags::Get().Ailment_Crumbled, ESoulCombatState::Crumbled},
+        {FSoulGameplayTags::Get().Buffer_Parry, ESoulCombatState::Parry},
+        {FSoulGameplayTags::Get().Buffer_Parry_Normal, ESoulCombatState::ParryNormal},
+        {FSoulGameplayTags::Get().Buffer_Parry_Perfect, ESoulCombatState::ParryPerfect},
+        {FSoulGameplayTags::Get().Buffer_Dodge, ESoulCombatState::Dodge}};
+    return CombatStateTags;
+}
+
 // Sets default values
 ASoulCharacterBase::ASoulCharacterBase()
 {
@@ -36,8 +55,49 @@ ASoulCharacterBase::ASoulCharacterBase()
     static ConstructorHelpers::FClassFinder<UGameplayEffect> GE_Dead_ClassFinder(TEXT("/Game/Abilities/GEs/GE_Ailment_Dead"));
     if(GE_Dead_ClassFinder.Succeeded()) DeadGE_Class = GE_Dead_ClassFinder.Class;
 
-    AbilitySystemComponent->OnGameplayEffectAppliedDelegateToSelf.AddUObject(this, &ASoulCharacterBase::BP_OnGameplayEffectApplied);
+    AbilitySystemComponent->OnGameplayEffectAppliedDelegateToSelf.AddUObject(this, &ASoulCharacterBase::HandleGameplayEffectApplied);
+    AbilitySystemComponent->OnPeriodicGameplayEffectExecuteDelegateOnSelf.AddUObject(this, &ASoulCharacterBase::HandleGameplayEffectExecuted);
     AbilitySystemComponent->OnAnyGameplayEffectRemovedDelegate().AddUObject(this, &ASoulCharacterBase::BP_OnGameplayEffectRemoved);
+
+    // Mirror combat state tags into bits, counting child tags like HasMatchingGameplayTag
+    CombatState.Store(ESoulCombatState::None);
+    for (const FCombatStateTag& CombatStateTag : GetCombatStateTags())
+    {
+        AbilitySystemComponent->RegisterGameplayTagEvent(CombatStateTag.Tag, EGameplayTagEventType::NewOrRemoved)
+                              .AddUObject(this, &ASoulCharacterBase::HandleCombatStateTagChanged, CombatStateTag.State);
+    }
+}
+
+void ASoulCharacterBase::HandleCombatStateTagChanged(const FGameplayTag Tag, int32 NewCount, uint32 State)
+{
+    const uint32 OldState = CombatState.Load(EMemoryOrder::Relaxed);
+    CombatState.Store(NewCount > 0 ? OldState | State : OldState & ~State);
+}
+
+void ASoulCharacterBase::HandleGameplayEffectExecuted(UAbilitySystemComponent* ASC, const FGameplayEffectSpec& EffectSpec,
+                                                      FActiveGameplayEffectHandle EffectHandle)
+{
+    AttributeSet->FlushPendingHit(EffectSpec);
+}
+
+void ASoulCharacterBase::HandleGameplayEffectApplied(UAbilitySystemComponent* ASC, const FGameplayEffectSpec& EffectSpec,
+                                                     FActiveGameplayEffectHandle EffectHandle)
+{
+    // Fires after an instant effect has executed
+    HandleGameplayEffectExecuted(ASC, EffectSpec, EffectHandle);
+
+    BP_OnGameplayEffectApplied(ASC, EffectSpec, EffectHandle);
+}
+
+uint32 ASoulCharacterBase::GetCombatStateFromTags(const FGameplayTagContainer& Tags)
+{
+    uint32 State = ESoulCombatState::None;
+    for (const FCombatStateTag& CombatStateTag : GetCombatStateTags())
+    {
+        if (Tags.HasTag(CombatStateTag.Tag))
+            State |= CombatStateTag.State;
+    }
+    return State;
 }
 
 
@@ -89,25 +149,24 @@ void ASoulCharacterBase::HandleOnCrumble(float PostureDamageAmount, const bool I
     BP_OnCrumbled(PostureDamageAmount, IsCriticaled, HitInfo, DamageTags, InstigatorCharacter, DamageCauser);
 }
 
-void ASoulCharacterBase::HandleDamage(float DamageAmount, const bool IsCriticaled, const bool bIsStun,
-                                      const FHitResult& HitInfo, const struct FGameplayTagContainer& DamageTags,
-                                      ASoulCharacterBase* InstigatorCharacter, AActor* DamageCauser)
+void ASoulCharacterBase::HandleHit(const FSoulHitRecord& Hit)
 {
-    OnDamaged(DamageAmount, IsCriticaled, bIsStun, HitInfo, DamageTags, InstigatorCharacter, DamageCauser);
-}
+    OnHit(Hit);
 
-void ASoulCharacterBase::HandleDotDamage(float DamageAmount, const bool IsCriticaled, const bool bIsStun,
-                                         const FHitResult& HitInfo, const struct FGameplayTagContainer& DamageTags,
-                                         ASoulCharacterBase* InstigatorCharacter, AActor* DamageCauser)
-{
-    OnDotDamaged(DamageAmount, IsCriticaled, bIsStun, HitInfo, DamageTags, InstigatorCharacter, DamageCauser);
-}
+    // Deprecated events fire as they did per output: health events only for a Damage output
+    if (Hit.bHasDamage)
+    {
+        if (Hit.bIsDot)
+            OnDotDamaged(Hit.DamageAmount, Hit.bIsCritical, Hit.bIsStun, Hit.HitInfo, Hit.DamageTags,
+                         Hit.InstigatorCharacter, Hit.DamageCauser);
+        else
+            OnDamaged(Hit.DamageAmount, Hit.bIsCritical, Hit.bIsStun, Hit.HitInfo, Hit.DamageTags,
+                      Hit.InstigatorCharacter, Hit.DamageCauser);
+    }
 
-void ASoulCharacterBase::HandlePostureDamage(float PostureDamageAmount, const bool IsCriticaled,
-                                             const FHitResult& HitInfo, const struct FGameplayTagContainer& DamageTags,
-                                             ASoulCharacterBase* InstigatorCharacter, AActor* DamageCauser)
-{
-    OnPostureDamaged(PostureDamageAmount, IsCriticaled, HitInfo, DamageTags, InstigatorCharacter, DamageCauser);
+    if (Hit.PostureDamageAmount > 0.f)
+        OnPostureDamaged(Hit.PostureDamageAmount, Hit.bIsCritical, Hit.HitInfo, Hit.DamageTags,
+                         Hit.InstigatorCharacter, Hit.DamageCauser);
 }
 
 void ASoulCharacterBase::ResetPerilousStatus()
@@ -2,5 +2,16 @@
 
 #include "Soul_Like_ACT.h"
 #include "Modules/ModuleManager.h"
+#include "Types/SoulGameplayTags.h"
 
-IMPLEMENT_PRIMARY_GAME_MODULE(FDefaultGameModuleImpl, Soul_Like_ACT, "Soul_Like_ACT");
+class FSoul_Like_ACTModule : public FDefaultGameModuleImpl
+{
+public:
+    virtual void StartupModule() override
+    {
+        // Resolve native gameplay tags before any gameplay code uses them
+        FSoulGameplayTags::Get();
+    }
+};
+
+IMPLEMENT_PRIMARY_GAME_MODULE(FSoul_Like_ACTModule, Soul_Like_ACT, "Soul_Like_ACT");
@@ -0,0 +1,35 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Types/DA_Gear.h"
+
+void UDA_Gear::RebuildBladeSamplePoints()
+{
+    BladeSamplePoints.Reset();
+    for (int i = BladeStartLength; i <= BladeTail; i += 20)
+    {
+        BladeSamplePoints.Add(FVector(0.f, 0.f, i));
+    }
+}
+
+void UDA_Gear::PostInitProperties()
+{
+    Super::PostInitProperties();
+
+    RebuildBladeSamplePoints();
+}
+
+void UDA_Gear::PostLoad()
+{
+    Super::PostLoad();
+
+    RebuildBladeSamplePoints();
+}
+
+#if WITH_EDITOR
+void UDA_Gear::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+    Super::PostEditChangeProperty(PropertyChangedEvent);
+
+    RebuildBladeSamplePoints();
+}
+#endif
@@ -0,0 +1,57 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Types/SoulGameplayTags.h"
+#include "Misc/AutomationTest.h"
+
+const FSoulGameplayTags& FSoulGameplayTags::Get()
+{
+    // Ability constructors run for class default objects during module load, so tags resolve on first use as well
+    static FSoulGameplayTags GameplayTags;
+    return GameplayTags;
+}
+
+FSoulGameplayTags::FSoulGameplayTags()
+{
+    AddTag(Ailment_Dead, TEXT("Ailment.Dead"));
+    AddTag(Ailment_Stun, TEXT("Ailment.Stun"));
+    AddTag(Ailment_Perilous, TEXT("Ailment.Perilous"));
+    AddTag(Ailment_Crumbled, TEXT("Ailment.Crumbled"));
+
+    AddTag(Buffer_Dodge, TEXT("Buffer.Dodge"));
+    AddTag(Buffer_Parry, TEXT("Buffer.Parry"));
+    AddTag(Buffer_Parry_Normal, TEXT("Buffer.Parry.Normal"));
+    AddTag(Buffer_Parry_Perfect, TEXT("Buffer.Parry.Perfect"));
+
+    AddTag(Damage_Critical, TEXT("Damage.Critical"));
+    AddTag(Damage_Dot, TEXT("Damage.Dot"));
+    AddTag(Damage_Stun, TEXT("Damage.Stun"));
+}
+
+void FSoulGameplayTags::AddTag(FGameplayTag& OutTag, const TCHAR* TagName)
+{
+    TagNames.Add(TagName);
+
+    OutTag = FGameplayTag::RequestGameplayTag(TagName, false);
+    if (!OutTag.IsValid())
+    {
+        UE_LOG(LogTemp, Error, TEXT("%s ERROR -> Native gameplay tag %s is not defined"), *FString(__FUNCTION__), TagName);
+    }
+}
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSoulGameplayTagsTest, "Soul_Like_ACT.GameplayTags", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FSoulGameplayTagsTest::RunTest(const FString& Parameters)
+{
+    // Requested again, so that tags removed from DefaultGameplayTags.ini or tag tables since startup are caught as well
+    for (const FName& TagName : FSoulGameplayTags::Get().GetTagNames())
+    {
+        TestTrue(FString::Printf(TEXT("Native gameplay tag %s must be defined in DefaultGameplayTags.ini or a tag table."), *TagName.ToString()),
+            FGameplayTag::RequestGameplayTag(TagName, false).IsValid());
+    }
+
+    return true;
+}
+
+#endif
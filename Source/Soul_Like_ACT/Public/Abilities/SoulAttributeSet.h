@@ -15,6 +15,51 @@
 	GAMEPLAYATTRIBUTE_VALUE_SETTER(PropertyName) \
 	GAMEPLAYATTRIBUTE_VALUE_INITTER(PropertyName)
 
+class ASoulCharacterBase;
+
+/** One hit taken by a character, gathered from every damage output of a single effect execution */
+USTRUCT(BlueprintType)
+struct FSoulHitRecord
+{
+    GENERATED_BODY()
+
+    /** Health damage done, not clamped based on current health */
+    UPROPERTY(BlueprintReadOnly)
+    float DamageAmount = 0.f;
+
+    UPROPERTY(BlueprintReadOnly)
+    float PostureDamageAmount = 0.f;
+
+    /** Whether the hit had a Damage output at all, as posture-only effects do not */
+    UPROPERTY(BlueprintReadOnly)
+    bool bHasDamage = false;
+
+    UPROPERTY(BlueprintReadOnly)
+    bool bIsCritical = false;
+
+    UPROPERTY(BlueprintReadOnly)
+    bool bIsStun = false;
+
+    /** Damage over time, which deals no posture damage */
+    UPROPERTY(BlueprintReadOnly)
+    bool bIsDot = false;
+
+    UPROPERTY(BlueprintReadOnly)
+    FHitResult HitInfo;
+
+    /** The gameplay tags of the event that did the damage */
+    UPROPERTY(BlueprintReadOnly)
+    FGameplayTagContainer DamageTags;
+
+    /** The character that initiated this damage */
+    UPROPERTY(BlueprintReadOnly)
+    ASoulCharacterBase* InstigatorCharacter = nullptr;
+
+    /** The actual actor that did the damage, might be a weapon or projectile */
+    UPROPERTY(BlueprintReadOnly)
+    AActor* DamageCauser = nullptr;
+};
+
 /** This holds all of the attributes used by abilities, it instantiates a copy of this on every character */
 UCLASS()
 class SOUL_LIKE_ACT_API USoulAttributeSet : public UAttributeSet
@@ -94,4 +139,31 @@ protected:
     void AdjustAttributeForMaxChange(FGameplayAttributeData& AffectedAttribute,
                                      const FGameplayAttributeData& MaxAttribute, float NewMaxValue,
                                      const FGameplayAttribute& AffectedAttributeProperty);
+
+public:
+    /**
+     * Delivers the hit gathered from ExecutedSpec to the owner. Called once the whole spec has executed,
+     * since every modifier and execution output of the spec reaches PostGameplayEffectExecute separately.
+     */
+    void FlushPendingHit(const struct FGameplayEffectSpec& ExecutedSpec);
+
+private:
+    /** Starts a hit record for the execution of Data.EffectSpec, resolving its source once */
+    void BeginPendingHit(const struct FGameplayEffectModCallbackData& Data);
+
+    /** Whether Spec is the one PendingHit gathers. Specs are copied while applied, so they are told apart by effect and context */
+    bool IsPendingHitSpec(const struct FGameplayEffectSpec& Spec) const;
+
+    /** Delivers the pending hit record to the owner, if any */
+    void DeliverPendingHit();
+
+    /** Hit being gathered from the Damage and PostureDamage outputs of one effect execution */
+    UPROPERTY(Transient)
+    FSoulHitRecord PendingHit;
+
+    bool bHasPendingHit = false;
+
+    /** Effect and context of the spec PendingHit gathers, only compared */
+    const class UGameplayEffect* PendingHitDef = nullptr;
+    FGameplayEffectContextHandle PendingHitContext;
 };
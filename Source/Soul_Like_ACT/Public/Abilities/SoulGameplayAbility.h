@@ -6,6 +6,7 @@
 #include "Abilities/GameplayAbility.h"
 #include "Abilities/SoulAbilityTypes.h"
 #include "GameplayTagContainer.h"
+#include "Types/SoulGameplayTags.h"
 #include "SoulGameplayAbility.generated.h"
 
 /**
@@ -64,15 +65,15 @@ class SOUL_LIKE_ACT_API USoulActiveAbility : public USoulGameplayAbility
 public:
     USoulActiveAbility()
     {
-        ActivationBlockedTags.AddTagFast(FGameplayTag::RequestGameplayTag("Ailment.Dead", true));
-        ActivationBlockedTags.AddTagFast(FGameplayTag::RequestGameplayTag("Ailment.Stun", true));
+        ActivationBlockedTags.AddTagFast(FSoulGameplayTags::Get().Ailment_Dead);
+        ActivationBlockedTags.AddTagFast(FSoulGameplayTags::Get().Ailment_Stun);
 
         CancelAbilitiesMatchingTagQuery.MakeQuery_MatchAnyTags(
             FGameplayTagContainer::CreateFromArray(
                 TArray<FGameplayTag>{
-                    FGameplayTag::RequestGameplayTag("Ailment.Dead"),
-                    FGameplayTag::RequestGameplayTag("Ailment.Perilous"),
-                    FGameplayTag::RequestGameplayTag("Ailment.Stun")}));
+                    FSoulGameplayTags::Get().Ailment_Dead,
+                    FSoulGameplayTags::Get().Ailment_Perilous,
+                    FSoulGameplayTags::Get().Ailment_Stun}));
     }
 };
 
@@ -127,8 +128,8 @@ class SOUL_LIKE_ACT_API UGA_Melee : public USoulGameplayAbility
 public:
     UGA_Melee()
     {
-        ActivationBlockedTags.AddTagFast(FGameplayTag::RequestGameplayTag("Ailment.Dead", true));
-        ActivationBlockedTags.AddTagFast(FGameplayTag::RequestGameplayTag("Ailment.Stun", true));
+        ActivationBlockedTags.AddTagFast(FSoulGameplayTags::Get().Ailment_Dead);
+        ActivationBlockedTags.AddTagFast(FSoulGameplayTags::Get().Ailment_Stun);
     }
     
 protected:
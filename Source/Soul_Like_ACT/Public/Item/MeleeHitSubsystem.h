@@ -0,0 +1,85 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "WorldCollision.h"
+#include "MeleeHitSubsystem.generated.h"
+
+class AWeaponActor;
+
+/**
+ * Blade segments of all swinging weapons in a frame, as structure of arrays.
+ * Segments of a weapon are consecutive, from FirstSegments to FirstSegments + NumSegments.
+ */
+struct FMeleeTraceBatch
+{
+    // Per segment
+    TArray<FVector> Starts;
+    TArray<FVector> Ends;
+    TArray<FQuat> Rotations;
+    TArray<FTraceHandle> Handles;
+
+    // Per weapon
+    TArray<TWeakObjectPtr<AWeaponActor>> Weapons;
+    TArray<int32> SwingSerials;
+    TArray<FCollisionShape> Shapes;
+    TArray<int32> FirstSegments;
+    TArray<int32> NumSegments;
+
+    /* Starts the segments of a weapon, traced with the given shape */
+    void AddWeapon(AWeaponActor* Weapon, const FCollisionShape& Shape);
+
+    /* Adds a segment to the last added weapon */
+    void AddSegment(const FVector& Start, const FVector& End, const FQuat& Rotation);
+
+    void Reset();
+};
+
+/**
+ * Traces the blades of all swinging weapons of a world as one batch of async traces per frame.
+ * Weapons register in StartSwing and unregister in EndSwing. Traces issued in a frame are resolved in the next one.
+ */
+UCLASS()
+class SOUL_LIKE_ACT_API UMeleeHitSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+    GENERATED_BODY()
+
+public:
+    void RegisterWeapon(AWeaponActor* Weapon);
+    void UnregisterWeapon(AWeaponActor* Weapon);
+
+    /**
+     * Applies hits of the traces issued for a weapon and drops them from the batch.
+     * Called when the swing ends, while the weapon's targets and damage still belong to the swing
+     * the traces were issued for. Traces not finished yet are done synchronously.
+     */
+    void ResolveWeapon(AWeaponActor* Weapon);
+
+    virtual void Deinitialize() override;
+
+    //~ Begin FTickableGameObject Interface
+    virtual void Tick(float DeltaTime) override;
+    virtual bool IsTickable() const override;
+    virtual TStatId GetStatId() const override;
+    //~ End FTickableGameObject Interface
+
+protected:
+    /* Applies hits of the traces issued in the previous frame, once per weapon */
+    void ResolveBatch();
+
+    void IssueBatch();
+
+    /* Applies hits of the segments of a weapon in the batch, if it is still in the swing they were traced for */
+    void ResolveBatchWeapon(int32 WeaponIndex);
+
+    static FCollisionQueryParams MakeQueryParams(const AWeaponActor* Weapon);
+
+    TArray<TWeakObjectPtr<AWeaponActor>> ActiveWeapons;
+
+    FMeleeTraceBatch Batch;
+
+    // Weapons ending their swings during Tick are dropped by Tick itself
+    bool bIsTicking = false;};
@@ -8,6 +8,7 @@
 #include "WeaponActor.generated.h"
 
 class ASoulCharacterBase;
+struct FMeleeTraceBatch;
 
 UCLASS()
 class SOUL_LIKE_ACT_API AWeaponActor : public AActor
@@ -17,6 +18,10 @@ class SOUL_LIKE_ACT_API AWeaponActor : public AActor
     UPROPERTY(VisibleAnywhere, meta = (AllowPrivateAccess = 1))
     class USkeletalMeshComponent* MeshComp;
 
+    // Renders rigid weapons, see UDA_Gear::StaticWeaponMesh
+    UPROPERTY(VisibleAnywhere, meta = (AllowPrivateAccess = 1))
+    class UStaticMeshComponent* StaticMeshComp;
+
     ASoulCharacterBase* OwnerRef;
 
 public:
@@ -35,25 +40,64 @@ protected:
 
     bool bIsTracingCollision;
 
-    TArray<FVector> PrevVecs;
-    TArray<FVector> CurrVecs;
+    // Transform of the blade when it was last traced
+    FTransform PrevBladeTransform;
+
+    // Incremented every swing, so that traces of a previous swing are not applied to the current one
+    int32 SwingSerial;
+
+    // Trace statistics of the current swing, logged when Soul.WeaponTraceParity is on
+    int32 SwingTraceCount;
+    int32 SwingParityTraceCount;
+    int32 SwingParityMismatches;
 
     UPROPERTY(BlueprintReadOnly, VisibleAnywhere)
-    TArray<AActor*> MyTargets;
+    TSet<AActor*> MyTargets;
 
     UPROPERTY(BlueprintReadOnly, VisibleAnywhere)
     float DmgMultiplier;
 
 public:
-    // Called every frame
-    virtual void Tick(float DeltaTime) override;
+    /* Traces the blade synchronously from its last traced transform, unless it moved too little and bFlush is false */
+    void CheckCollision(bool bFlush = false);
+
+    /* Adds segments of the blade moved since its last traced transform to a batch traced by UMeleeHitSubsystem */
+    void AddBladeSegments(FMeleeTraceBatch& Batch);
+
+    /* Whether the blade must be traced synchronously, to draw traces or check trace parity */
+    bool NeedsSynchronousTrace() const;
+
+    void ApplyHits(const TArray<FHitResult>& Hits);
+
+    int32 GetSwingSerial() const { return SwingSerial; }
 
 protected:
-    void CheckCollision();
+    static FVector GetBladePoint(const FTransform& BladeTransform, float Length);
+
+    /* Returns the number of substeps to trace the blade to its current transform in, or zero if it moved too little */
+    int32 GetNumSubsteps(const FTransform& CurrBladeTransform, bool bFlush) const;
+
+    /* Transforms UDA_Gear::BladeSamplePoints into world space */
+    void TransformBladePoints(const FTransform& BladeTransform, TArray<FVector, TInlineAllocator<16>>& OutPoints) const;
+
+    FCollisionShape GetBladeShape(EWeaponTraceMode TraceMode) const;
+
+    /* Calls Function with the start, end and rotation of every trace of the blade with the given mode in substeps, sweeps being further split by angle */
+    void ForEachBladeSegment(EWeaponTraceMode TraceMode, const FTransform& CurrBladeTransform, int32 NumSubsteps,
+        TFunctionRef<void(const FVector&, const FVector&, const FQuat&)> Function) const;
+
+    /* Traces the blade with the given mode in substeps, and returns the number of traces used */
+    int32 TraceBlade(EWeaponTraceMode TraceMode, const FTransform& CurrBladeTransform, int32 NumSubsteps, TArray<FHitResult>& OutHits, bool bDrawTrace) const;
+
+    void SweepBlade(const FCollisionShape& Shape, const FVector& Start, const FVector& End, const FQuat& Rotation, TArray<FHitResult>& OutHits, bool bDrawTrace) const;
+
+    void CollectRivalTargets(const TArray<FHitResult>& Hits, TArray<AActor*>& OutTargets) const;
+
+    void CheckTraceParity(EWeaponTraceMode TraceMode, const FTransform& CurrBladeTransform, int32 NumSubsteps, const TArray<FHitResult>& Hits);
 
     bool TryExcludeActor(AActor* HitActor);
 
-    void DrawTraceLine(FVector prevVec_, FVector currVec_, bool bDrawTraceLine);
+    void DrawTraceLine(FVector prevVec_, FVector currVec_, bool bDrawTraceLine, TArray<FHitResult>& OutHits) const;
 
 public:
     UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Weapon, meta = (ExposeOnSpawn = 1))
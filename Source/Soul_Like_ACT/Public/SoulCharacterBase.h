@@ -8,6 +8,8 @@
 #include "Abilities/SoulAbilitySystemComponent.h"
 #include "Abilities/SoulAttributeSet.h"
 #include "Interfaces/Targetable.h"
+#include "Types/SoulGameplayTags.h"
+#include "Templates/Atomic.h"
 #include "SoulCharacterBase.generated.h"
 
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnChanged, const TArray<float> &, values);
@@ -45,6 +47,24 @@ enum class EIsControllerValid : uint8
 			On##PropertyName##Changed.Broadcast(TArray<float>{Get##PropertyName##(), GetMax##PropertyName##()}); \
 	}
 
+/**
+ * Bits of ASoulCharacterBase::GetCombatState, each mirrored from a gameplay tag or its children
+ */
+namespace ESoulCombatState
+{
+    enum Type : uint32
+    {
+        None = 0,
+        Dead = 1 << 0,
+        Stun = 1 << 1,
+        Crumbled = 1 << 2,
+        Parry = 1 << 3,
+        ParryNormal = 1 << 4,
+        ParryPerfect = 1 << 5,
+        Dodge = 1 << 6,
+    };
+}
+
 UENUM(BlueprintType)
 enum class EActorFaction : uint8
 {
@@ -97,6 +117,16 @@ protected:
     UPROPERTY(BlueprintReadOnly, EditDefaultsOnly, Category = GameplayEffects)
     TSubclassOf<UGameplayEffect> DeadGE_Class;    
 
+    /** Bits of ESoulCombatState, written on the game thread only when tag counts of the ability system component change */
+    TAtomic<uint32> CombatState;
+
+    void HandleCombatStateTagChanged(const FGameplayTag Tag, int32 NewCount, uint32 State);
+
+    /** Flushes the hit gathered by AttributeSet once an instant effect or a period of a periodic one has executed */
+    void HandleGameplayEffectExecuted(UAbilitySystemComponent* ASC, const FGameplayEffectSpec& EffectSpec, FActiveGameplayEffectHandle EffectHandle);
+
+    void HandleGameplayEffectApplied(UAbilitySystemComponent* ASC, const FGameplayEffectSpec& EffectSpec, FActiveGameplayEffectHandle EffectHandle);
+
     FTimerHandle Handle_SlowMotion, Handler_SlowMotionDelay;
 
     void WaitForDilationReset()
@@ -173,22 +203,31 @@ public:
     UFUNCTION(BlueprintCallable)
     virtual int32 GetCharacterLevel() const { return 1; }
 
+    /** Combat state bits of ESoulCombatState. Safe to read from any thread, e.g. animation worker threads */
+    uint32 GetCombatState() const { return CombatState.Load(EMemoryOrder::Relaxed); }
+
+    /** Returns true if any of the given ESoulCombatState bits is set */
+    bool HasCombatState(uint32 States) const { return (GetCombatState() & States) != 0; }
+
+    /** Combat state bits of a tag container, for actors without a combat state */
+    static uint32 GetCombatStateFromTags(const FGameplayTagContainer& Tags);
+
     UFUNCTION(BlueprintCallable)
     bool GetIsDead() const
     {
-        return AbilitySystemComponent->HasMatchingGameplayTag(FGameplayTag::RequestGameplayTag("Ailment.Dead"));;
+        return HasCombatState(ESoulCombatState::Dead);
     }
     
     UFUNCTION(BlueprintCallable)
     bool GetIsStun() const
     {
-        return AbilitySystemComponent->HasMatchingGameplayTag(FGameplayTag::RequestGameplayTag("Ailment.Stun"));
+        return HasCombatState(ESoulCombatState::Stun);
     }
 
     UFUNCTION(BlueprintCallable)
     bool GetIsCrumbled() const
     {
-        return AbilitySystemComponent->HasMatchingGameplayTag(FGameplayTag::RequestGameplayTag("Ailment.Crumbled"));
+        return HasCombatState(ESoulCombatState::Crumbled);
     }
 
     UFUNCTION(BlueprintCallable)
@@ -202,28 +241,25 @@ protected:
     void AddStartupGameplayAbilities();
 
     /**
-     * Called when character takes damage, which may have killed them
+     * Called once per hit the character takes, which may have killed them
      *
-     * @param DamageAmount Amount of damage that was done, not clamped based on current health
-     * @param HitInfo The hit info that generated this damage
-     * @param DamageTags The gameplay tags of the event that did the damage
-     * @param InstigatorCharacter The character that initiated this damage
-     * @param DamageCauser The actual actor that did the damage, might be a weapon or projectile
-     */    
+     * @param Hit Health and posture damage of the hit, with the hit info, damage tags, instigator and causer
+     */
     UFUNCTION(BlueprintImplementableEvent)
+    void OnHit(const FSoulHitRecord& Hit);
+
+    // Per-output hit events, still forwarded from HandleHit while Blueprints move to OnHit. Removed in the next release.
+    UFUNCTION(BlueprintImplementableEvent, meta = (DeprecatedFunction, DeprecationMessage = "Removed in the next release. Use OnHit, which reports health and posture damage of a hit at once"))
     void OnDamaged(float DamageAmount, const bool IsCriticaled, const bool bIsStun, const FHitResult& HitInfo,
                    const struct FGameplayTagContainer& DamageTags, ASoulCharacterBase* InstigatorCharacter,
                    AActor* DamageCauser);
 
-    UFUNCTION(BlueprintImplementableEvent)
+    UFUNCTION(BlueprintImplementableEvent, meta = (DeprecatedFunction, DeprecationMessage = "Removed in the next release. Use OnHit and check bIsDot"))
     void OnDotDamaged(float DamageAmount, const bool IsCriticaled, const bool bIsStun, const FHitResult& HitInfo,
                       const struct FGameplayTagContainer& DamageTags, ASoulCharacterBase* InstigatorCharacter,
                       AActor* DamageCauser);
 
-    /**
-    *Called when character takes posture damage
-    */
-    UFUNCTION(BlueprintImplementableEvent)
+    UFUNCTION(BlueprintImplementableEvent, meta = (DeprecatedFunction, DeprecationMessage = "Removed in the next release. Use OnHit, which reports health and posture damage of a hit at once"))
     void OnPostureDamaged(float PostureDamageAmount, const bool IsCriticaled, const FHitResult& HitInfo,
                           const struct FGameplayTagContainer& DamageTags, ASoulCharacterBase* InstigatorCharacter,
                           AActor* DamageCauser);
@@ -276,20 +312,11 @@ protected:
     FTrigger_OnMeleeAttack OnMeleeKill;
 
     // Called from RPGAttributeSet, these call BP events above
-    virtual void HandleDamage(float DamageAmount, const bool IsCriticaled, const bool bIsStun,
-                              const FHitResult& HitInfo, const struct FGameplayTagContainer& DamageTags,
-                              ASoulCharacterBase* InstigatorCharacter, AActor* DamageCauser);
-    virtual void HandleDotDamage(float DamageAmount, const bool IsCriticaled, const bool bIsStun,
-                                 const FHitResult& HitInfo, const struct FGameplayTagContainer& DamageTags,
-                                 ASoulCharacterBase* InstigatorCharacter, AActor* DamageCauser);
+    virtual void HandleHit(const FSoulHitRecord& Hit);
     virtual void HandleOnDead(const FHitResult& HitInfo,
                           const struct FGameplayTagContainer& DamageTags, ASoulCharacterBase* InstigatorCharacter,
                           AActor* DamageCauser);
 
-    virtual void HandlePostureDamage(float PostureDamageAmount, const bool IsCriticaled, const FHitResult& HitInfo,
-                                     const struct FGameplayTagContainer& DamageTags,
-                                     ASoulCharacterBase* InstigatorCharacter, AActor* DamageCauser);
-
     virtual void HandleOnCrumble(float PostureDamageAmount, const bool IsCriticaled, const FHitResult& HitInfo,
                       const struct FGameplayTagContainer& DamageTags, ASoulCharacterBase* InstigatorCharacter,
                       AActor* DamageCauser);
@@ -14,6 +14,14 @@ enum class EWeaponType : uint8
     VE_Fist UMETA(DisplayName = "Fist"),
 };
 
+UENUM(BlueprintType)
+enum class EWeaponTraceMode : uint8
+{
+    VE_LineSamples UMETA(DisplayName = "LineSamples"),
+    VE_CapsuleSweep UMETA(DisplayName = "CapsuleSweep"),
+    VE_BoxSweep UMETA(DisplayName = "BoxSweep"),
+};
+
 /**
  * 
  */
@@ -36,12 +44,40 @@ public:
     UPROPERTY(EditAnywhere, BlueprintReadWrite)
     class USkeletalMesh* WeaponMesh;
 
+    // If set, the weapon is rigid and rendered with this mesh instead of a skeletal mesh
+    UPROPERTY(EditAnywhere, BlueprintReadWrite)
+    class UStaticMesh* StaticWeaponMesh;
+
     UPROPERTY(EditAnywhere, BlueprintReadWrite)
     int32 BladeStartLength = 20;
 
     UPROPERTY(EditAnywhere, BlueprintReadWrite)
     int32 BladeTail = 120;
 
+    // LineSamples traces one line per 20 units of blade, sweeps trace the whole blade once per sweep
+    UPROPERTY(EditAnywhere, BlueprintReadWrite)
+    EWeaponTraceMode TraceMode = EWeaponTraceMode::VE_LineSamples;
+
+    // Radius of the swept capsule, or half thickness of the swept box
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = 0))
+    float BladeRadius = 5.f;
+
+    // The blade is traced in substeps once its tail travels farther than this in a frame
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = 1))
+    float MaxSubstepDistance = 30.f;
+
+    // Upper bound of substeps per frame, which bounds the traces per frame
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = 1))
+    int32 MaxSubsteps = 4;
+
+    // Upper bound of sweeps per substep. Sweeps split a substep so that each turns the blade ends by less than BladeRadius
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = 1))
+    int32 MaxSweepsPerSubstep = 8;
+
+    // The blade is not traced until its tail travels at least this far, so that slow swings at high frame rates do not trace tiny movements
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = 0))
+    float MinTraceDistance = 2.f;
+
     UPROPERTY(EditAnywhere, BlueprintReadWrite)
     USoundBase* SwingSound;
 
@@ -53,4 +89,18 @@ public:
 
     UPROPERTY(EditAnywhere, BlueprintReadWrite)
     UParticleSystem* OnHitFX;
+
+    // Local space points traced by LineSamples, every 20 units from BladeStartLength to BladeTail along Z
+    UPROPERTY(VisibleAnywhere, Transient)
+    TArray<FVector> BladeSamplePoints;
+
+    bool IsRigid() const { return StaticWeaponMesh != nullptr; }
+
+    void RebuildBladeSamplePoints();
+
+    virtual void PostInitProperties() override;
+    virtual void PostLoad() override;
+#if WITH_EDITOR
+    virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
 };
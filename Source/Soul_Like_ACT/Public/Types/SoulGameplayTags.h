@@ -0,0 +1,41 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameplayTagContainer.h"
+
+/**
+ * Gameplay tags referenced from C++, resolved once at module startup instead of from strings on every use
+ * Every tag must be defined in DefaultGameplayTags.ini or a tag table, which the Soul_Like_ACT.GameplayTags automation test checks
+ */
+struct SOUL_LIKE_ACT_API FSoulGameplayTags
+{
+    static const FSoulGameplayTags& Get();
+
+    FGameplayTag Ailment_Dead;
+    FGameplayTag Ailment_Stun;
+    FGameplayTag Ailment_Perilous;
+    FGameplayTag Ailment_Crumbled;
+
+    FGameplayTag Buffer_Dodge;
+    FGameplayTag Buffer_Parry;
+    FGameplayTag Buffer_Parry_Normal;
+    FGameplayTag Buffer_Parry_Perfect;
+
+    FGameplayTag Damage_Critical;
+    FGameplayTag Damage_Dot;
+    FGameplayTag Damage_Stun;
+
+    /* Names of all the tags above, in the order of declaration */
+    const TArray<FName>& GetTagNames() const { return TagNames; }
+
+private:
+    FSoulGameplayTags();
+    FSoulGameplayTags(const FSoulGameplayTags&) = delete;
+    FSoulGameplayTags& operator=(const FSoulGameplayTags&) = delete;
+
+    void AddTag(FGameplayTag& OutTag, const TCHAR* TagName);
+
+    TArray<FName> TagNames;
+};